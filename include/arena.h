@@ -0,0 +1,38 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_ALIGN 16                // every allocation starts on this boundary
+#define ARENA_CHUNK_SIZE (64 * 1024) // default chunk size, bigger requests get their own chunk
+
+typedef struct ArenaChunk ArenaChunk;
+
+// Bump allocator: allocations are carved out of chunks and never freed one by one,
+// arena_delete releases everything at once. A zeroed Arena is ready to use.
+typedef struct
+{
+    ArenaChunk *head; // chunk allocations are carved from, newest first
+    size_t chunk_size;
+
+    // diagnostics
+    long allocations;  // arena_alloc calls
+    int chunks;        // chunks currently held
+    size_t used;       // bytes handed out, alignment padding included
+    size_t reserved;   // bytes held in chunks
+    size_t high_water; // largest `used` seen, survives arena_reset
+} Arena;
+
+void arena_init(Arena *arena, size_t chunk_size);
+void *arena_alloc(Arena *arena, size_t size); // uninitialized, NULL when out of memory
+void *arena_calloc(Arena *arena, size_t count, size_t size);
+
+// forgets every allocation but keeps the newest chunk for reuse
+void arena_reset(Arena *arena);
+void arena_delete(Arena *arena);
+
+// cJSON allocates from `arena` on the calling thread while it is set, NULL restores malloc/free.
+// Nodes are then released with the arena instead of cJSON_Delete.
+void arena_useForJSON(Arena *arena);
+
+#endif // ARENA_H
@@ -6,6 +6,8 @@
 #include <shader.h>
 #include <sphere.h>
 #include <cylinder.h>
+#include <structure.h>
+#include <vertex.h>
 
 typedef struct
 {
@@ -22,37 +24,26 @@ typedef enum
     TRIPLE_BOND
 } BondType;
 
+// Per-instance attributes of the shared unit sphere (see static/atom_vs.glsl)
 typedef struct
 {
-    char symbol[4]; // Atomic symbol (e.g., "H", "O", "Cl")
-
-    vec3 position; // 3D coordinates of the atom (x, y, z)
-    vec3 color;    // RGBA color for the atom
-    float radius;  // Atomic radius for rendering (e.g., van der Waals radius)
-    float angle;
-
-    Sphere *sphere;
-} Atom;
+    vec3 center;      // location 3 (xyz)
+    float radius;     // location 3 (w)
+    GLubyte color[4]; // location 1, RGBA8
+} AtomInstance;
 
+// Per-instance attributes of the shared unit cylinder (see static/vertex_shader.glsl)
 typedef struct
 {
-    BondType type;
-
-    vec3 color;
-    float radius;
-    float angle;
-
-    Cylinder *cy;
-} Bond;
+    mat4 transform;   // locations 3-6, unit cylinder -> molecule space
+    GLubyte color[4]; // location 1, RGBA8
+} BondInstance;
 
-void atom_init(Atom *atom, const char *symbol, vec3 position, vec3 color, float radius);
-void atom_setAngle(Atom *atom, float angle);
-void atom_draw(Atom *atom, Shader *sh, mat4 view, mat4 projection);
-void atom_delete(Atom *atom);
+// a bond expands to one instance per line (single, double, triple)
+#define BOND_MAX_INSTANCES 3
 
-void bond_init(Bond *bond, BondType type, Atom *a1, Atom *a2, vec3 color, float radius);
-void bond_setAngle(Bond *bond, float angle);
-void bond_draw(Bond *bond, Shader *sh, mat4 view, mat4 projection);
-void bond_delete(Bond *bond);
+// instance data of atom / bond `i` of a structure, in molecule space
+void atom_getInstance(const Structure *s, int i, AtomInstance *instance);
+int bond_getInstances(const Structure *s, int i, BondType type, vec3 color, float radius, BondInstance instances[BOND_MAX_INSTANCES]);
 
 #endif // ATOM_H
@@ -0,0 +1,20 @@
+#ifndef BONDS_H
+#define BONDS_H
+
+#include <structure.h>
+
+// two atoms are bonded when their distance lies in (BONDS_MIN_DISTANCE, r1 + r2 + BONDS_TOLERANCE),
+// r being covalent radii, the same rule Open Babel uses for files without connectivity
+#define BONDS_TOLERANCE 0.45f
+#define BONDS_MIN_DISTANCE 0.4f
+
+#define BONDS_MAX_THREADS 8
+#define BONDS_ATOMS_PER_THREAD 16384 // smaller inputs are not worth a thread
+
+// Replaces the bonds of `s` with single bonds perceived from atom distances. Atoms are hashed
+// into a grid of cells as wide as the longest possible bond, so each atom is only compared
+// with the atoms of its 27 neighboring cells: linear time, split across threads.
+// Returns the bond count, or -1 on error with `s` unchanged.
+int bonds_perceive(Structure *s);
+
+#endif // BONDS_H
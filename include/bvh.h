@@ -0,0 +1,44 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <cglm/cglm.h>
+#include <arena.h>
+
+#define BVH_LEAF_SIZE 16  // items per leaf at most, a leaf is culled or kept as a whole when possible
+#define BVH_STACK_SIZE 64 // traversal depth, object median splits stay far below it
+
+// axis-aligned box; a leaf holds items[first, first + count), an inner node (count 0)
+// has its children at first and first + 1
+typedef struct
+{
+    vec3 min;
+    int first;
+    vec3 max;
+    int count;
+} BvhNode;
+
+// Bounding volume hierarchy over bounding spheres (center xyz, radius w), built with
+// object median splits along the longest axis so every leaf holds BVH_LEAF_SIZE / 2 or more items.
+typedef struct
+{
+    BvhNode *nodes; // root first, children always after their parent
+    int node_count;
+    int *items; // item indices grouped by leaf
+    int item_count;
+} Bvh;
+
+// allocates from `arena`, returns 0 on success and -1 on error
+int bvh_build(Bvh *bvh, Arena *arena, const vec4 *spheres, int count);
+
+// recomputes every box after the spheres moved, the tree shape is kept
+void bvh_refit(Bvh *bvh, const vec4 *spheres);
+
+// extra test of a leaf that passed the frustum, returns 0 to drop all of its items
+typedef int (*BvhLeafTest)(const BvhNode *leaf, void *user);
+
+// writes the indices of the items whose sphere is inside or intersects the frustum of
+// `planes` (glm_frustum_planes, same space as the spheres) and whose leaf passes `test`
+// (NULL passes all) to `visible`, returns their count
+int bvh_cull(const Bvh *bvh, const vec4 *spheres, vec4 planes[6], BvhLeafTest test, void *user, int *visible);
+
+#endif // BVH_H
@@ -0,0 +1,35 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <molecule.h>
+
+// Persistent cache of generated conformers. Records live in one directory, named by a
+// hash of the normalized molecule string and the generator options, and the least
+// recently used ones are evicted once the directory grows past its size limit.
+// Safe to use from the loader thread and the render thread at once.
+typedef struct ConformerCache ConformerCache;
+
+typedef struct
+{
+    long hits;
+    long misses;
+    long stores;
+    long evictions;
+    long bytes; // size of the records on disk, rescanned when it grows past the limit
+} CacheStats;
+
+ConformerCache *cache_create(const char *dir, long max_bytes);
+
+// `options` identifies the generator (e.g. its command line), records made with other options never match.
+// fills mol->structure from a cached record, returns 0 on a hit and -1 on a miss
+int cache_lookup(ConformerCache *cache, const char *molecule_str, const char *options, Molecule *mol);
+
+// writes mol->structure, returns 0 on success and -1 on error
+int cache_store(ConformerCache *cache, const char *molecule_str, const char *options, const Molecule *mol);
+
+CacheStats cache_getStats(ConformerCache *cache);
+void cache_printStats(ConformerCache *cache);
+
+void cache_delete(ConformerCache *cache);
+
+#endif // CACHE_H
@@ -4,8 +4,9 @@
 #include <shader.h>
 #include <glad/glad.h>
 #include <cglm/cglm.h>
+#include <vertex.h>
 
-#define CUBE_VERTICES 216
+#define CUBE_VERTICES 8
 #define CUBE_INDICES 36
 
 typedef struct
@@ -15,17 +16,13 @@ typedef struct
     unsigned int EBO;
 
     vec3 position; // center of cube
-    vec3 color;
+    vec3 color;    // also the light color when the cube marks the light
     float scale;
-
-    // 24 vertices (3 position, 3 color)
-    float vertices[CUBE_VERTICES];
-    unsigned int indices[CUBE_INDICES];
 } Cube;
 
 void cube_init(Cube *cube, vec3 position, vec3 color, float scale);
 
-void cube_draw(Cube *cube, Shader *sh, mat4 view, mat4 projection);
+void cube_draw(Cube *cube, Shader *sh);
 
 void cube_delete(Cube *cube);
 
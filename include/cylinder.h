@@ -4,33 +4,33 @@
 #include <glad/glad.h>
 #include <cglm/cglm.h>
 #include <shader.h>
+#include <vertex.h>
 
 #define CY_SECTOR_COUNT 36
 #define CY_PI M_PI
 
+// vertices and indices of a cylinder with `sectors` sides
+#define CYLINDER_VERTEX_COUNT(sectors) (2 * ((sectors) + 1))
+#define CYLINDER_INDEX_COUNT(sectors) (6 * (sectors))
+
+// Unit cylinder mesh (radius 1, height 1 along z, centred at the origin),
+// uploaded once and shared by every bond through instanced draws.
+// CY_SECTOR_COUNT is the finest tessellation. Vertices are generated into
+// scratch memory that is released after upload, only the GL handles stay.
 typedef struct
 {
-    unsigned int VAO;
     unsigned int VBO;
     unsigned int EBO;
+    unsigned int index_count;
 
-    vec3 position; // center of sphere
-    vec3 direction;
-    vec3 color;
-    float radius;
-    float height;
-    float angle;
-
-    float vertices[2 * 9 * (CY_SECTOR_COUNT + 1)];
-    unsigned int indices[6 * CY_SECTOR_COUNT];
+    int sectors;
 } Cylinder;
 
-void cylinder_init(Cylinder *cylinder, vec3 position, vec3 direction, vec3 color, float radius, float height);
-
-void cylinder_setAngle(Cylinder *cylinder, float angle);
+void cylinder_init(Cylinder *cylinder, int sectors);
 
-void cylinder_draw(Cylinder *cylinder, Shader *sh, mat4 view, mat4 projection);
+// binds the mesh buffers and vertex attributes (0: position, 2: normal) of MeshVertex into the current VAO
+void cylinder_bind(Cylinder *cylinder);
 
 void cylinder_delete(Cylinder *cylinder);
 
-#endif // CYLINDER_H
\ No newline at end of file
+#endif // CYLINDER_H
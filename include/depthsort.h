@@ -0,0 +1,37 @@
+#ifndef DEPTHSORT_H
+#define DEPTHSORT_H
+
+#include <cglm/cglm.h>
+#include <arena.h>
+
+#define DEPTHSORT_KEY_BITS 16     // view depth quantization of the full order
+#define DEPTHSORT_MAX_ANGLE 4.0f  // degrees the view direction may turn before the order is rebuilt
+
+// Front-to-back order of bounding spheres (center xyz, radius w) for early depth rejection.
+// View depth is linear along the view direction, so the order holds wherever the camera
+// moves as long as it keeps looking the same way: the full order is only rebuilt once the
+// direction turned more than DEPTHSORT_MAX_ANGLE, every frame just sorts its visible list
+// by position in that order. Both sorts are radix sorts (see radix.h).
+typedef struct
+{
+    int count;
+    int *order;                 // every item, front to back at the last rebuild
+    unsigned int *rank;         // position of each item in order
+    unsigned int *keys;         // sort keys and scratch, count each
+    unsigned int *scratch_keys;
+    int *scratch_items;
+    int rank_bits;              // bits of the largest rank
+    vec3 direction;             // view direction of the last rebuild, same space as the spheres
+    int valid;                  // order matches the spheres
+} DepthSort;
+
+// allocates from `arena`, returns 0 on success and -1 on error
+int depthsort_init(DepthSort *sort, Arena *arena, int count);
+
+// rebuilds the order when it is invalid or the view turned too far, returns 1 when it did
+int depthsort_update(DepthSort *sort, const vec4 *spheres, mat4 modelView);
+
+// reorders the `count` item indices of `visible` front to back
+void depthsort_apply(DepthSort *sort, int *visible, int count);
+
+#endif // DEPTHSORT_H
@@ -0,0 +1,35 @@
+#ifndef ELEMENT_H
+#define ELEMENT_H
+
+#include <cglm/cglm.h>
+
+#define ELEMENT_COUNT 119 // atomic numbers 1..118, 0 is unknown
+
+// atoms are drawn at this fraction of their van der Waals radius (ball and stick),
+// except H, C, N and O, which keep the radii the viewer has always drawn them with
+#define ELEMENT_BALL_SCALE 0.18f
+
+// Static per-element data shared by every loader, indexed by atomic number.
+// Radii are in angstrom, ionic_radius is 0 for elements without a common ion.
+typedef struct
+{
+    char symbol[4];
+    unsigned char color[3]; // Jmol CPK color, sRGB
+    float mass;             // standard atomic weight
+    float vdw_radius;
+    float covalent_radius; // single bond
+    float ionic_radius;    // most common ion, six-coordinate
+} Element;
+
+// entry of an atomic number, out of range ids map to the unknown element 0
+const Element *element_get(int id);
+
+// atomic number of a symbol in constant time, case-insensitive ("CL" is chlorine),
+// D and T are hydrogen, 0 when unknown
+int element_id(const char *symbol);
+const char *element_symbol(int id);
+
+// rendering color and sphere radius of an element
+void element_props(int element, vec3 color, float *radius);
+
+#endif // ELEMENT_H
@@ -0,0 +1,26 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+// Offscreen GL 3.3 core context without a window or display server: a surfaceless EGL
+// context (Mesa, llvmpipe on machines without a GPU) rendering into a framebuffer object
+// of any size. Linux only, EGL is not available on Windows.
+typedef struct
+{
+    void *display; // EGLDisplay
+    void *context; // EGLContext
+    unsigned int FBO;
+    unsigned int colorRBO; // RGBA8
+    unsigned int depthRBO; // 24-bit depth
+    int width, height;
+} Headless;
+
+// creates the context, loads GL through glad and leaves the framebuffer bound with a matching
+// viewport; returns 0 on success and -1 on error
+int headless_create(Headless *headless, int width, int height);
+
+// writes the color buffer as a binary PPM, top row first; returns 0 on success and -1 on error
+int headless_writeImage(const Headless *headless, const char *path);
+
+void headless_delete(Headless *headless);
+
+#endif // HEADLESS_H
@@ -0,0 +1,62 @@
+#ifndef HIZ_H
+#define HIZ_H
+
+#include <glad/glad.h>
+#include <cglm/cglm.h>
+#include <shader.h>
+
+#define HIZ_WIDTH 320      // the GPU halves the viewport until a level is at most this wide, that one is read back
+#define HIZ_MAX_LEVELS 16  // 2^15 texels wide is far beyond any viewport
+
+// Hierarchical depth buffer for occlusion culling. Occluders are rendered at viewport
+// resolution into a depth texture, which the GPU reduces into levels where every texel
+// holds the farthest depth of the 2x2 texels below it. The first level at most HIZ_WIDTH
+// wide is read back through a pixel buffer one frame later, without stalling, and reduced
+// further on the CPU. A box whose nearest point is farther than everything the pyramid
+// holds over its screen rectangle is hidden.
+typedef struct
+{
+    int viewport_width, viewport_height;
+    unsigned int depthFBO;     // occluders at viewport resolution
+    unsigned int depthTexture;
+    unsigned int reduceFBO[HIZ_MAX_LEVELS];     // GPU levels, each half the previous one (rounding up)
+    unsigned int reduceTexture[HIZ_MAX_LEVELS]; // R32F
+    int reduce_count;
+    unsigned int reduceVAO; // empty, the full-screen triangle comes from gl_VertexID
+    unsigned int PBO;       // last GPU level, read back asynchronously
+    int pending;            // PBO holds a readback not yet turned into the pyramid
+    mat4 pending_mvp;
+
+    int width, height; // CPU level 0, the last GPU level
+    int shift;         // viewport pixel -> level 0 texel
+    float *levels[HIZ_MAX_LEVELS]; // window-space depth, level 0 first, one allocation
+    int level_width[HIZ_MAX_LEVELS];
+    int level_height[HIZ_MAX_LEVELS];
+    int level_count;
+
+    mat4 mvp;  // object space -> clip space of the occluders in the pyramid
+    int valid; // the pyramid holds occluders rendered with mvp
+
+    int previousFBO; // restored by hiz_end
+    int previousViewport[4];
+} HiZ;
+
+// (re)creates the buffers for a viewport, cheap when the size did not change;
+// returns 0 on success and -1 on error
+int hiz_resize(HiZ *hiz, int viewport_width, int viewport_height);
+
+// turns last frame's readback into the pyramid, call before testing
+void hiz_update(HiZ *hiz);
+
+// binds and clears the depth framebuffer, draw the occluders (transformed by mvp) in between
+void hiz_begin(HiZ *hiz, mat4 mvp);
+// reduces the depth with `reduce` (static/hiz_reduce_fs.glsl), starts the readback and
+// restores the previous framebuffer; the pyramid is ready at the next hiz_update
+void hiz_end(HiZ *hiz, const Shader *reduce);
+
+// 1 when the object-space box [min, max] is hidden behind the occluders
+int hiz_occluded(const HiZ *hiz, const vec3 min, const vec3 max);
+
+void hiz_delete(HiZ *hiz);
+
+#endif // HIZ_H
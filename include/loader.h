@@ -0,0 +1,23 @@
+#ifndef LOADER_H
+#define LOADER_H
+
+#include <molecule.h>
+
+// Background worker generating molecules (Open Babel + molfile parsing) off the
+// render thread. Results are CPU-side only, the render thread uploads them.
+typedef struct Loader Loader;
+
+Loader *loader_create(void);
+
+// queue a molecule string, replacing any request that has not started yet
+void loader_request(Loader *loader, const char *molecule_str);
+
+// returns a finished molecule (not yet uploaded) or NULL, the caller owns it
+Molecule *loader_poll(Loader *loader);
+
+// 1 while a request is queued or being generated
+int loader_busy(Loader *loader);
+
+void loader_delete(Loader *loader);
+
+#endif // LOADER_H
@@ -0,0 +1,24 @@
+#ifndef MESHOPT_H
+#define MESHOPT_H
+
+#include <stddef.h>
+#include <vertex.h>
+
+// post-transform cache size the optimizer targets and ACMR is measured with
+#define MESHOPT_CACHE_SIZE 16
+
+// build with -DMESHOPT_VERBOSE to print the ACMR of the unit meshes before and after optimizing
+
+// average cache miss ratio: transformed vertices per triangle with a FIFO cache of
+// `cache_size` entries, 0.5 is the ideal for large meshes and 3 the worst case
+float meshopt_acmr(const MeshIndex *indices, int index_count, int vertex_count, int cache_size);
+
+// reorders triangles for the post-transform vertex cache (Tipsify, Sander et al. 2007),
+// returns 0 on success and -1 when out of memory (indices are then left untouched)
+int meshopt_optimizeCache(MeshIndex *indices, int index_count, int vertex_count, int cache_size);
+
+// reorders vertices (of `stride` bytes) in the order the indices first use them and
+// remaps the indices, unused vertices go last; returns 0 on success and -1 when out of memory
+int meshopt_optimizeFetch(void *vertices, size_t stride, int vertex_count, MeshIndex *indices, int index_count);
+
+#endif // MESHOPT_H
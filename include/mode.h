@@ -1,6 +1,7 @@
 #ifndef MODE_H
 #define MODE_H
 
+#include <stddef.h>
 #include <GLFW/glfw3.h>
 
 #define INPUT_BUFFER_SIZE 256
@@ -18,4 +19,7 @@ extern char inputBuffer[INPUT_BUFFER_SIZE];
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mods);
 void char_callback(GLFWwindow *windows, unsigned int codepoint);
 
+// copies the line submitted with Enter in insert mode, returns 1 once per submission
+int mode_pollSubmitted(char *out, size_t size);
+
 #endif // MODE_H
@@ -0,0 +1,64 @@
+#ifndef MOLBIN_H
+#define MOLBIN_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Binary molecule file (.molb), little-endian, version MOLB_VERSION.
+//
+//   MolbHeader
+//   x, y, z     float per atom, one section each
+//   elements    uint8 atomic number per atom, 0 is unknown
+//   bond_a, b   uint32 0-based atom index per bond, one section each
+//   bond_order  uint8 per bond, 1 single, 2 double, 3 triple
+//
+// The sections match the arrays of a Structure, so loading copies each one whole.
+// Colors and radii are derived from the elements when loading, so records written before
+// a change to the element table still render with the current one.
+//
+// Every section starts at the offset recorded in the header, aligned to MOLB_ALIGN, so a
+// mapped file can be handed to glBufferData section by section without any parsing.
+#define MOLB_MAGIC "MOLB"
+#define MOLB_VERSION 3
+#define MOLB_ALIGN 16
+#define MOLB_EXT ".molb"
+
+typedef struct
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t header_size; // sizeof(MolbHeader) of the writer
+    uint32_t atom_count;
+    uint32_t bond_count;
+    uint32_t flags; // reserved, 0
+
+    uint64_t x_offset, y_offset, z_offset;
+    uint64_t elements_offset;
+    uint64_t bond_a_offset, bond_b_offset;
+    uint64_t bond_order_offset;
+    uint64_t file_size;
+
+    char name[64];
+} MolbHeader;
+
+// read-only view of a mapped file, the arrays point into the mapping
+typedef struct
+{
+    const MolbHeader *header;
+    const float *x, *y, *z;
+    const uint8_t *elements;
+    const uint32_t *bond_a, *bond_b;
+    const uint8_t *bond_order;
+
+    void *base;
+    size_t size;
+#ifdef _WIN32
+    void *mapping; // HANDLE of the file mapping
+#endif
+} MolbFile;
+
+// maps and validates a file, returns 0 on success and -1 on error
+int molb_open(MolbFile *file, const char *filename);
+void molb_close(MolbFile *file);
+
+#endif // MOLBIN_H
@@ -4,29 +4,147 @@
 #include <cglm/cglm.h>
 #include <shader.h>
 #include <atom.h>
+#include <structure.h>
+#include <arena.h>
+#include <bvh.h>
+#include <hiz.h>
+#include <depthsort.h>
 
 #define Y_AIXS (vec3){0.0f, 1.0f, 0.0f}
 
+typedef enum
+{
+    ATOM_STYLE_MESH,    // tessellated unit sphere
+    ATOM_STYLE_IMPOSTOR // ray-cast sphere on a screen-aligned quad
+} AtomStyle;
+
+typedef enum
+{
+    BOND_STYLE_MESH,    // tessellated unit cylinder
+    BOND_STYLE_IMPOSTOR // ray-cast capped cylinder in a bounding box
+} BondStyle;
+
+// levels of detail of the unit sphere and cylinder, 0 is the finest
+#define MOL_LOD_COUNT 4
+
+// GPU culling drops atoms whose projected radius is smaller than this many pixels
+#define MOL_CULL_MIN_PIXELS 0.5f
+
+typedef struct
+{
+    int draw_calls;
+    long triangles;
+    int atom_lod_counts[MOL_LOD_COUNT]; // mesh atoms drawn per level of detail
+    int bond_lod_counts[MOL_LOD_COUNT]; // mesh bond lines drawn per level of detail
+    int atoms_visible;                  // atoms left after frustum (and occlusion) culling
+    int bonds_visible;                  // bond lines left after frustum (and occlusion) culling
+    int clusters_tested;                // hierarchy leaves tested against the depth pyramid
+    int clusters_culled;                // of those, hidden behind the occluders
+    int clusters_drawn;                 // of those, submitted
+    int atoms_resorted;                 // the front-to-back atom order was rebuilt
+    long atom_fragments;                // atom samples that passed the depth test in the previous frame, with overdraw_stats
+} FrameStats;
+
 typedef struct
 {
     char name[64]; // Molecule name (e.g., "Water", "Methane")
 
-    int atom_count; // Number of atoms in the molecule
-    int bond_count; // Number of bonds in the molecule
+    Arena arena;         // owns every CPU-side allocation below, released at once by molecule_delete
+    Structure structure; // atoms and bonds, the chemical data
 
+    // molecule -> world transform, model = translate(position) * rotate_y(angle) * scale
     float angle;
+    vec3 position;
+    float scale;
+    mat4 model;
+    mat3 normal; // rotation part of model, transforms normals without an inverse
+
+    AtomStyle atom_style;
+    BondStyle bond_style;
+
+    int viewport[2]; // framebuffer size in pixels, drives the level of detail
+
+    int occlusion; // test hierarchy leaves against a depth pyramid of the last visible atoms
+    HiZ hiz;       // depth pyramid, filled with this frame's visible atoms for the next one
 
-    Atom *atoms; // Array of atoms
-    Bond *bonds; // Array of bonds
+    int gpu_culling; // cull atoms with transform feedback instead of atom_bvh (needs MoleculeShaders.atom_cull)
+
+    int depth_sort;       // draw visible atoms front to back (CPU culling only)
+    DepthSort atom_sort;  // front-to-back order of atom_bounds
+    int overdraw_stats;   // count atom fragments into stats.atom_fragments, a query per frame
+    unsigned int overdrawQueries[2]; // samples passed while drawing atoms, alternating frames
+    int overdraw_frame;   // frames counted by overdrawQueries
+    int overdraw_begun[2]; // the query was started and its result not read yet
+
+    int uploaded; // holds a reference on the shared unit meshes
+
+    AtomInstance *atom_instances; // per-atom instance data
+    vec4 *atom_bounds;            // bounding sphere per atom, molecule space
+    Bvh atom_bvh;                 // over atom_bounds, built at upload
+    int *atom_visible;            // this frame's atoms inside the view frustum
+    AtomInstance *atom_frame;     // this frame's visible instances (grouped by level of detail for meshes)
+    unsigned char *atom_lod;      // this frame's level of detail per visible atom
+    unsigned int atomImpostorVAO; // per-atom instance attributes of atomFrameVBO, quads come from gl_VertexID
+    unsigned int atomFrameVBO;    // atom_frame, streamed every frame
+    unsigned int atomLodVAO[MOL_LOD_COUNT]; // unit sphere of each level + atomFrameVBO
+    unsigned int atomInstanceVBO; // atom_instances, source of the GPU culling pass
+    unsigned int atomCullVAO;     // one point per atom of atomInstanceVBO
+    unsigned int atomCullQueries[MOL_LOD_COUNT]; // instances the GPU culling pass wrote per level of detail
+
+    int bond_instance_count;      // one per line of single/double/triple bonds
+    BondInstance *bond_instances; // per-line instance data
+    vec4 *bond_bounds;            // bounding sphere per line, molecule space
+    Bvh bond_bvh;                 // over bond_bounds, built at upload
+    int *bond_visible;            // this frame's lines inside the view frustum
+    BondInstance *bond_frame;     // this frame's visible instances (grouped by level of detail for meshes)
+    unsigned char *bond_lod;      // this frame's level of detail per visible line
+    unsigned int bondImpostorVAO; // per-line instance attributes of bondFrameVBO, boxes come from gl_VertexID
+    unsigned int bondFrameVBO;    // bond_frame, streamed every frame
+    unsigned int bondLodVAO[MOL_LOD_COUNT]; // unit cylinder of each level + bondFrameVBO
+
+    FrameStats stats; // counters of the last molecule_draw
 } Molecule;
 
+typedef struct
+{
+    Shader *atom;          // instanced atoms (static/atom_vs.glsl)
+    Shader *atom_impostor; // ray-cast atoms (static/atom_impostor_vs.glsl)
+    Shader *bond;          // instanced bonds (static/vertex_shader.glsl)
+    Shader *bond_impostor; // ray-cast bonds (static/bond_impostor_vs.glsl)
+    Shader *atom_cull;     // GPU atom culling (static/atom_cull_vs.glsl), NULL keeps it on the CPU
+    Shader *hiz_reduce;    // depth pyramid levels (static/hiz_reduce_fs.glsl), NULL disables occlusion culling
+} MoleculeShaders;
+
 // helper functions
 void load_molecule_from_JSON(const char *filename, Molecule *mol);
+
+// binary molecule files (see molbin.h), mapped instead of parsed; return 0 on success and -1 on error
+int load_molecule_from_binary(const char *filename, Molecule *mol);
+int save_molecule_binary(const char *filename, const Molecule *mol);
+
+// conformers are read from / written to `cache` (see cache.h) instead of always running Open Babel, NULL disables it
+typedef struct ConformerCache ConformerCache;
+void molecule_setConformerCache(ConformerCache *cache);
+
+Molecule *generate_molecule_data(const char *molecule_str); // CPU side only, safe off the render thread
 Molecule *generate_molecule(const char *molecule_str);
 
-void molecule_init(Molecule *mol, const char *name, int atom_count, Atom *atoms, int bond_count, Bond *bonds);
+// both return 0 on success and -1 when the GPU side could not be created, the molecule is then not drawable
+int molecule_init(Molecule *mol, const char *name, Structure *structure); // takes over a malloc'd structure
+int molecule_upload(Molecule *mol);
+void molecule_refit(Molecule *mol); // after the structure's atoms moved: new instances, refitted hierarchies
 void molecule_setAngle(Molecule *mol, float angle);
-void molecule_draw(Molecule *mol, Shader *sh, mat4 view, mat4 projection);
+void molecule_setPosition(Molecule *mol, vec3 position);
+void molecule_setScale(Molecule *mol, float scale);
+void molecule_setAtomStyle(Molecule *mol, AtomStyle style);
+void molecule_setBondStyle(Molecule *mol, BondStyle style);
+void molecule_setViewport(Molecule *mol, int width, int height);
+void molecule_setOcclusion(Molecule *mol, int enabled);
+void molecule_setGpuCulling(Molecule *mol, int enabled);
+void molecule_setDepthSort(Molecule *mol, int enabled);
+void molecule_setOverdrawStats(Molecule *mol, int enabled);
+void molecule_draw(Molecule *mol, MoleculeShaders *shaders, mat4 view, mat4 projection);
+void molecule_printMemory(Molecule *mol, const char *stage); // arena diagnostics and resident CPU bytes
 void molecule_delete(Molecule *mol);
 
 #endif // MOLECULE_H
@@ -0,0 +1,23 @@
+#ifndef PARSE_H
+#define PARSE_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <molecule.h>
+#include <element.h>
+
+// rendering properties shared by every loader, per element ones are in element.h
+BondType bond_order_props(int order, vec3 color, float *radius);
+
+// MDL molfile (V2000): counts line, atom block and bond block.
+// Fills mol->structure, returns 0 on success and -1 on error.
+int parse_molfile(const char *data, size_t size, Molecule *mol);
+int load_molecule_from_molfile(const char *filename, Molecule *mol);
+int load_molecule_from_stream(FILE *fp, Molecule *mol); // reads fp to EOF, e.g. a pipe
+
+// XYZ (first frame only): atom count, comment line, then "symbol x y z" per atom.
+// Has no connectivity, bonds are perceived from distances (see bonds.h).
+int parse_xyz(const char *data, size_t size, Molecule *mol);
+int load_molecule_from_xyz(const char *filename, Molecule *mol);
+
+#endif // PARSE_H
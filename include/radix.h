@@ -0,0 +1,15 @@
+#ifndef RADIX_H
+#define RADIX_H
+
+#define RADIX_DIGIT_BITS 8
+#define RADIX_MAX_THREADS 8
+#define RADIX_SERIAL_COUNT (1 << 20) // smaller inputs sort on the calling thread, starting threads costs more
+
+// Stable LSD radix sort of `items` by `keys` (both `count` long, keys below 1 << key_bits),
+// one pass per RADIX_DIGIT_BITS of key, each split across threads: every thread counts the
+// digits of its range, then scatters it to offsets all ranges agreed on. The threads are
+// started once per sort and meet at a barrier between the steps. The scratch arrays hold
+// `count` elements; the result always ends up in keys and items.
+void radix_sort(unsigned int *keys, int *items, unsigned int *scratch_keys, int *scratch_items, int count, int key_bits);
+
+#endif // RADIX_H
@@ -5,13 +5,59 @@
 #include <cglm/cglm.h>
 #include <glad/glad.h>
 
+#define SHADER_MAX_UNIFORMS 16
+#define SHADER_UNIFORM_NAME_SIZE 32
+
+// binding point of the per-frame uniform block "Frame" in every program
+#define SHADER_FRAME_BINDING 0
+
+// uniforms used by the draw loop, resolved once at link time (-1 if inactive)
+typedef enum
+{
+    SHADER_UNIFORM_MODEL,
+    SHADER_UNIFORM_NORMAL_MATRIX,
+    SHADER_UNIFORM_TEXT,
+    SHADER_UNIFORM_TEXT_COLOR,
+    SHADER_UNIFORM_MODEL_VIEW,
+    SHADER_UNIFORM_PLANES,
+    SHADER_UNIFORM_PIXEL_SCALE,
+    SHADER_UNIFORM_PIXEL_RANGE,
+    SHADER_UNIFORM_COUNT
+} ShaderUniform;
+
+typedef struct
+{
+    char name[SHADER_UNIFORM_NAME_SIZE];
+    int location;
+} ShaderUniformInfo;
+
 typedef struct
 {
     unsigned int ID;
+
+    // active default-block uniforms reflected at link time
+    int uniform_count;
+    ShaderUniformInfo uniforms[SHADER_MAX_UNIFORMS];
+
+    int locations[SHADER_UNIFORM_COUNT];
 } Shader;
 
+// std140 layout of the "Frame" uniform block, shared by every program
+typedef struct
+{
+    mat4 view;
+    mat4 projection;
+    mat4 screen; // orthographic pixel projection for the text overlay
+    vec4 lightPos;
+    vec4 lightColor;
+} FrameUniforms;
+
 Shader *shader_create(const char *vertexPath, const char *fragmentPath);
+// vertex + geometry program without a fragment stage whose `varyings` are captured interleaved
+// by transform feedback; NULL when it does not compile or link, callers fall back to the CPU
+Shader *shader_createFeedback(const char *vertexPath, const char *geometryPath, const char *const *varyings, int varying_count);
 void shader_use(const Shader *shader);
+int shader_getLocation(const Shader *shader, const char *name);
 void shader_setBool(const Shader *shader, const char *name, bool value);
 void shader_setInt(const Shader *shader, const char *name, int value);
 void shader_setFloat(const Shader *shader, const char *name, float value);
@@ -19,4 +65,18 @@ void shader_setMat4(const Shader *shader, const char *name, mat4 mat);
 void shader_setVec3(const Shader *shader, const char *name, vec3 v);
 void shader_delete(Shader *shader);
 
+// set a cached uniform of the program currently in use
+void shader_setUniformMat4(const Shader *shader, ShaderUniform uniform, mat4 mat);
+void shader_setUniformMat3(const Shader *shader, ShaderUniform uniform, mat3 mat);
+void shader_setUniformVec3(const Shader *shader, ShaderUniform uniform, vec3 v);
+void shader_setUniformInt(const Shader *shader, ShaderUniform uniform, int value);
+void shader_setUniformFloat(const Shader *shader, ShaderUniform uniform, float value);
+void shader_setUniformVec2(const Shader *shader, ShaderUniform uniform, vec2 v);
+void shader_setUniformVec4Array(const Shader *shader, ShaderUniform uniform, vec4 *v, int count);
+
+// per-frame uniform buffer bound at SHADER_FRAME_BINDING
+unsigned int shader_frameCreate(void);
+void shader_frameUpdate(unsigned int ubo, const FrameUniforms *frame);
+void shader_frameDelete(unsigned int ubo);
+
 #endif // SHADER_H
@@ -4,31 +4,35 @@
 #include <glad/glad.h>
 #include <cglm/cglm.h>
 #include <shader.h>
+#include <vertex.h>
 
 #define STACK_COUNT 18
 #define SECTOR_COUNT 36
 #define SP_PI M_PI
 
+// vertices and indices of a stacks x sectors sphere
+#define SPHERE_VERTEX_COUNT(stacks, sectors) (((sectors) + 1) * ((stacks) + 1))
+#define SPHERE_INDEX_COUNT(stacks, sectors) (6 * ((stacks) - 1) * (sectors))
+
+// Unit sphere mesh (radius 1, centred at the origin), uploaded once and
+// shared by every atom through instanced draws. STACK_COUNT x SECTOR_COUNT
+// is the finest tessellation. Vertices are generated into scratch memory
+// that is released after upload, only the GL handles stay.
 typedef struct
 {
-    unsigned int VAO;
     unsigned int VBO;
     unsigned int EBO;
+    unsigned int index_count;
 
-    vec3 position; // center of sphere
-    vec3 color;
-    float radius;
-    float angle;
-
-    float vertices[9 * (SECTOR_COUNT + 1) * (STACK_COUNT + 1)];
-    unsigned int indices[6 * (STACK_COUNT - 1) * SECTOR_COUNT];
+    int stacks;
+    int sectors;
 } Sphere;
 
-void sphere_init(Sphere *sphere, vec3 position, vec3 color, float radius);
-
-void sphere_setAngle(Sphere *sphere, float angle);
+void sphere_init(Sphere *sphere, int stacks, int sectors);
 
-void sphere_draw(Sphere *sphere, Shader *sh, mat4 view, mat4 projection);
+// binds the mesh buffers and vertex attribute 0 (position) into the current VAO,
+// PositionVertex only: on a unit sphere the normal is the position
+void sphere_bind(Sphere *sphere);
 
 void sphere_delete(Sphere *sphere);
 
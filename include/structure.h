@@ -0,0 +1,51 @@
+#ifndef STRUCTURE_H
+#define STRUCTURE_H
+
+#include <stddef.h>
+#include <cglm/cglm.h>
+#include <arena.h>
+
+#define STRUCTURE_ALIGN 16         // every array starts on this boundary
+#define STRUCTURE_PALETTE_SIZE 256 // distinct atom colors per structure
+
+// Chemical data of a molecule: atoms and bonds, one array per attribute, all in a
+// single allocation. Holds no rendering state, the GPU side lives in Molecule.
+typedef struct
+{
+    int atom_count;
+    int bond_count;
+
+    // atoms
+    float *x, *y, *z;
+    float *radius;
+    unsigned char *element; // atomic number, 0 is unknown
+    unsigned char *color;   // index into palette
+
+    // bonds
+    int *bond_a, *bond_b;      // 0-based atom indices
+    unsigned char *bond_order; // 1 single, 2 double, 3 triple
+
+    vec3 palette[STRUCTURE_PALETTE_SIZE];
+    int palette_count;
+
+    void *block; // owns every array above
+    size_t block_size;
+    Arena *arena; // the block's owner, NULL when it is malloc'd
+} Structure;
+
+// allocates room for the atoms and bonds from `arena` (or malloc when NULL), returns 0 on success and -1 on error
+int structure_init(Structure *s, Arena *arena, int atom_count, int bond_count);
+
+// re-lays out the block for `bond_count` bonds keeping the atoms and the leading bonds,
+// returns 0 on success and -1 on error (s is then unchanged). An arena keeps the old block.
+int structure_resizeBonds(Structure *s, int bond_count);
+
+void structure_setAtom(Structure *s, int i, int element, vec3 position, vec3 color, float radius);
+void structure_setBond(Structure *s, int i, int a, int b, int order);
+
+void structure_getPosition(const Structure *s, int i, vec3 position);
+void structure_getColor(const Structure *s, int i, vec3 color);
+
+void structure_delete(Structure *s);
+
+#endif // STRUCTURE_H
@@ -0,0 +1,36 @@
+#ifndef VERTEX_H
+#define VERTEX_H
+
+#include <glad/glad.h>
+#include <cglm/cglm.h>
+
+// Compact vertex formats of the shared meshes. Positions are signed normalized
+// 16-bit (every mesh fits in [-1, 1]), normals GL_INT_2_10_10_10_REV and indices
+// 16-bit, every generated mesh has far fewer than 65536 vertices.
+
+// position only, the normal is derived from it in the shader (unit sphere)
+typedef struct
+{
+    GLshort position[4]; // x, y, z, pad
+} PositionVertex;
+
+typedef struct
+{
+    GLshort position[4]; // x, y, z, pad
+    GLuint normal;       // 2_10_10_10_REV, w = 0
+} MeshVertex;
+
+typedef GLushort MeshIndex;
+#define MESH_INDEX_TYPE GL_UNSIGNED_SHORT
+
+void vertex_packPosition(vec3 position, GLshort packed[4]);
+GLuint vertex_packNormal(vec3 normal);
+
+// attribute 0 (position) and, for MeshVertex, 2 (normal) from the bound GL_ARRAY_BUFFER into the current VAO
+void vertex_bindPosition(void);
+void vertex_bindMesh(void);
+
+// 8-bit normalized RGBA, the per-instance color format
+void vertex_packColor(vec3 color, GLubyte packed[4]);
+
+#endif // VERTEX_H
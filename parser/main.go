@@ -5,6 +5,7 @@ import (
 	"bytes"
 	"encoding/json"
 	"fmt"
+	"io"
 	"log"
 	"os"
 	"strconv"
@@ -152,10 +153,29 @@ func read(p []byte) (*Molecule, error) {
 	return mol, nil
 }
 
+// main converts a V2000 molfile to JSON.
+//
+//	go run parser/main.go [in.mol|- [out.json|-]]
+//
+// Missing paths or "-" mean stdin/stdout, so it can sit in a pipe after obabel.
 func main() {
-	f, err := os.ReadFile("data/molecule.mol")
+	in, out := "-", "-"
+	if len(os.Args) > 1 {
+		in = os.Args[1]
+	}
+	if len(os.Args) > 2 {
+		out = os.Args[2]
+	}
+
+	var f []byte
+	var err error
+	if in == "-" {
+		f, err = io.ReadAll(os.Stdin)
+	} else {
+		f, err = os.ReadFile(in)
+	}
 	if err != nil {
-		log.Fatalf("failed to open file, %v", err)
+		log.Fatalf("failed to read input, %v", err)
 	}
 
 	mol, err := read(f)
@@ -168,8 +188,12 @@ func main() {
 		log.Fatalf("failed to marshal JSON: %v", err)
 	}
 
-	err = os.WriteFile("data/molecule.json", jsonData, 0644)
+	if out == "-" {
+		_, err = os.Stdout.Write(jsonData)
+	} else {
+		err = os.WriteFile(out, jsonData, 0644)
+	}
 	if err != nil {
-		log.Fatal("failed to write to file")
+		log.Fatal("failed to write output")
 	}
 }
@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cjson/cJSON.h>
+#include <arena.h>
+
+struct ArenaChunk
+{
+    ArenaChunk *next;
+    size_t size; // usable bytes after the header
+    size_t used;
+};
+
+// header rounded up so the chunk's data keeps ARENA_ALIGN
+#define CHUNK_HEADER ((sizeof(ArenaChunk) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+static size_t align_up(size_t size)
+{
+    return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+void arena_init(Arena *arena, size_t chunk_size)
+{
+    memset(arena, 0, sizeof(Arena));
+    arena->chunk_size = chunk_size;
+}
+
+static ArenaChunk *arena_grow(Arena *arena, size_t size)
+{
+    size_t chunk_size = arena->chunk_size ? arena->chunk_size : ARENA_CHUNK_SIZE;
+    if (size > chunk_size)
+        chunk_size = size;
+
+    ArenaChunk *chunk = malloc(CHUNK_HEADER + chunk_size);
+    if (!chunk)
+        return NULL;
+
+    chunk->next = arena->head;
+    chunk->size = chunk_size;
+    chunk->used = 0;
+    arena->head = chunk;
+    arena->chunks++;
+    arena->reserved += chunk_size;
+    return chunk;
+}
+
+void *arena_alloc(Arena *arena, size_t size)
+{
+    size = align_up(size > 0 ? size : 1);
+
+    ArenaChunk *chunk = arena->head;
+    if (!chunk || chunk->size - chunk->used < size)
+    {
+        chunk = arena_grow(arena, size);
+        if (!chunk)
+        {
+            printf("Memory allocation error in arena\n");
+            return NULL;
+        }
+    }
+
+    void *ptr = (char *)chunk + CHUNK_HEADER + chunk->used;
+    chunk->used += size;
+
+    arena->allocations++;
+    arena->used += size;
+    if (arena->used > arena->high_water)
+        arena->high_water = arena->used;
+    return ptr;
+}
+
+void *arena_calloc(Arena *arena, size_t count, size_t size)
+{
+    void *ptr = arena_alloc(arena, count * size);
+    if (ptr)
+        memset(ptr, 0, count * size);
+    return ptr;
+}
+
+void arena_reset(Arena *arena)
+{
+    if (!arena->head)
+        return;
+
+    // keep the newest chunk, release the rest
+    ArenaChunk *chunk = arena->head->next;
+    while (chunk)
+    {
+        ArenaChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    arena->head->next = NULL;
+    arena->head->used = 0;
+
+    arena->chunks = 1;
+    arena->reserved = arena->head->size;
+    arena->used = 0;
+}
+
+void arena_delete(Arena *arena)
+{
+    ArenaChunk *chunk = arena->head;
+    while (chunk)
+    {
+        ArenaChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    size_t chunk_size = arena->chunk_size;
+    memset(arena, 0, sizeof(Arena));
+    arena->chunk_size = chunk_size;
+}
+
+// cJSON hooks are process wide, the arena they allocate from is per thread
+static _Thread_local Arena *jsonArena = NULL;
+
+static void *json_malloc(size_t size)
+{
+    return jsonArena ? arena_alloc(jsonArena, size) : malloc(size);
+}
+
+static void json_free(void *ptr)
+{
+    if (!jsonArena)
+        free(ptr);
+}
+
+void arena_useForJSON(Arena *arena)
+{
+    static int hooked = 0;
+    if (!hooked)
+    {
+        cJSON_Hooks hooks = {json_malloc, json_free};
+        cJSON_InitHooks(&hooks);
+        hooked = 1;
+    }
+    jsonArena = arena;
+}
@@ -1,118 +1,72 @@
 #include <atom.h>
 
 // Atom
-void atom_init(Atom *atom, const char *symbol, vec3 position, vec3 color, float radius)
+void atom_getInstance(const Structure *s, int i, AtomInstance *instance)
 {
-    // Copy the symbol (e.g., "H", "O", "Cl")
-    strncpy(atom->symbol, symbol, sizeof(atom->symbol) - 1);
-    atom->symbol[sizeof(atom->symbol) - 1] = '\0';
-
-    // Set atom properties
-    glm_vec3_copy(position, atom->position);
-    glm_vec3_copy(color, atom->color);
-    atom->radius = radius;
-
-    atom->sphere = (Sphere *)malloc(sizeof(Sphere));
-    if (atom->sphere)
-    {
-        sphere_init(atom->sphere, atom->position, atom->color, atom->radius);
-    }
-}
-
-void atom_setAngle(Atom *atom, float angle)
-{
-    if (atom->sphere)
-    {
-        sphere_setAngle(atom->sphere, angle);
-    }
-};
-
-void atom_draw(Atom *atom, Shader *sh, mat4 view, mat4 projection)
-{
-    if (atom->sphere)
-    {
-        sphere_draw(atom->sphere, sh, view, projection);
-    }
-};
-
-void atom_delete(Atom *atom)
-{
-    if (atom->sphere)
-    {
-        sphere_delete(atom->sphere);
-        free(atom->sphere);
-    }
+    vec3 color;
+    structure_getPosition(s, i, instance->center);
+    structure_getColor(s, i, color);
+    vertex_packColor(color, instance->color);
+    instance->radius = s->radius[i];
 };
 
 // Bond
-void bond_init(Bond *bond, BondType type, Atom *a1, Atom *a2, vec3 color, float radius)
+int bond_getInstances(const Structure *s, int i, BondType type, vec3 color, float radius, BondInstance instances[BOND_MAX_INSTANCES])
 {
-    bond->type = type;
-    bond->radius = radius;
-    glm_vec3_copy(color, bond->color);
-
-    vec3 position;
-    glm_vec3_add(a1->position, a2->position, position);
-    glm_vec3_scale(position, 0.5f, position);
-
-    vec3 direction;
-    glm_vec3_sub(a2->position, a1->position, direction);
+    vec3 a, b;
+    structure_getPosition(s, s->bond_a[i], a);
+    structure_getPosition(s, s->bond_b[i], b);
+
+    // midpoint, unit direction from the first to the second atom and length
+    vec3 center, direction;
+    glm_vec3_center(a, b, center);
+    glm_vec3_sub(b, a, direction);
+    float height = glm_vec3_norm(direction);
     glm_vec3_normalize(direction);
 
-    float height = glm_vec3_distance(a1->position, a2->position);
+    // rotation taking the cylinder's z axis onto the bond direction
+    mat4 rotation;
+    glm_mat4_identity(rotation);
+
+    vec3 z_axis = {0.0f, 0.0f, 1.0f};
+    vec3 rotation_axis;
+    glm_vec3_cross(z_axis, direction, rotation_axis);
 
-    bond->cy = (Cylinder *)malloc(sizeof(Cylinder));
-    if (bond->cy)
+    float angle = acosf(glm_vec3_dot(z_axis, direction));
+    if (glm_vec3_norm(rotation_axis) > 0.001f) // Avoid zero division
     {
-        cylinder_init(bond->cy, position, direction, bond->color, bond->radius, height);
+        glm_vec3_normalize(rotation_axis);
+        glm_rotate(rotation, angle, rotation_axis);
     }
-};
 
-void bond_setAngle(Bond *bond, float angle)
-{
-    if (bond->cy)
+    // multi-bonds are spread along a vector perpendicular to the bond
+    vec3 perpendicular;
+    vec3 up = {0.0f, 0.0f, 1.0f};
+
+    glm_vec3_cross(direction, up, perpendicular);
+    if (glm_vec3_norm(perpendicular) < 0.001f) // Edge case: parallel to Z-axis
     {
-        cylinder_setAngle(bond->cy, angle);
+        vec3 right = {1.0f, 0.0f, 0.0f};
+        glm_vec3_cross(direction, right, perpendicular);
     }
-};
+    glm_vec3_normalize(perpendicular);
 
-void bond_draw(Bond *bond, Shader *sh, mat4 view, mat4 projection)
-{
-    if (bond->cy)
+    int count = type + 1;
+    for (int line = 0; line < count; line++)
     {
-        vec3 perpendicular;
-        vec3 up = {0.0f, 0.0f, 1.0f};
-
-        glm_vec3_cross(bond->cy->direction, up, perpendicular);
-        if (glm_vec3_norm(perpendicular) < 0.001f) // Edge case: parallel to Y-axis
-        {
-            vec3 right = {1.0f, 0.0f, 0.0f};
-            glm_vec3_cross(bond->cy->direction, right, perpendicular);
-        }
-        glm_vec3_normalize(perpendicular);
+        float offset = 3 * radius * (line - type / 2.0f);
 
-        for (int i = 0; i < bond->type + 1; i++)
-        {
-            float offset = 3 * bond->radius * (i - bond->type / 2.0f);
-            vec3 offset_vector;
-            glm_vec3_scale(perpendicular, offset, offset_vector);
+        vec3 position;
+        glm_vec3_copy(center, position);
+        glm_vec3_muladds(perpendicular, offset, position);
 
-            vec3 original_position;
-            glm_vec3_copy(bond->cy->position, original_position);
-            glm_vec3_add(original_position, offset_vector, bond->cy->position);
+        mat4 *transform = &instances[line].transform;
+        glm_translate_make(*transform, position);
+        glm_mat4_mul(*transform, rotation, *transform);
+        glm_scale(*transform, (vec3){radius, radius, height});
 
-            cylinder_draw(bond->cy, sh, view, projection);
-
-            glm_vec3_copy(original_position, bond->cy->position);
-        }
+        vertex_packColor(color, instances[line].color);
     }
-};
 
-void bond_delete(Bond *bond)
-{
-    if (bond->cy)
-    {
-        cylinder_delete(bond->cy);
-        free(bond->cy);
-    }
-};
\ No newline at end of file
+    return count;
+};
@@ -0,0 +1,275 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <element.h>
+#include <bonds.h>
+
+// Atoms bucketed by grid cell, counting-sorted so the atoms of a bucket are contiguous.
+// Compact systems index a dense grid, sparse ones hash the cell so memory stays linear;
+// distinct cells may then share a bucket, the per-atom cell tells them apart.
+typedef struct
+{
+    const Structure *s;
+    float cellInv;
+    float origin[3];
+    int dims[3];             // cells per axis of a dense grid, 0 when hashed
+    unsigned int mask;       // bucket_count - 1 of a hashed grid, a power of two
+    unsigned int bucketCount;
+    int *cell;        // x, y, z cell per atom
+    int *bucketStart; // bucketCount + 1 offsets into atoms
+    int *atoms;       // atom indices sorted by bucket
+} BondGrid;
+
+// a dense grid may have this many cells per atom before hashing takes over
+#define BONDS_DENSE_CELLS_PER_ATOM 8
+
+// bonds found by one thread for atoms [begin, end), ordered by the lower atom
+typedef struct
+{
+    const BondGrid *grid;
+    int begin, end;
+
+    int *pairs; // a, b per bond
+    int count, capacity;
+    int failed;
+} BondWorker;
+
+// bucket of a cell, neighbors of border cells fall outside a dense grid and get the empty last bucket
+static unsigned int cell_bucket(const BondGrid *grid, int x, int y, int z)
+{
+    if (grid->dims[0])
+    {
+        if (x < 0 || y < 0 || z < 0 || x >= grid->dims[0] || y >= grid->dims[1] || z >= grid->dims[2])
+            return grid->bucketCount - 1;
+        return (unsigned int)x + grid->dims[0] * ((unsigned int)y + grid->dims[1] * (unsigned int)z);
+    }
+    return ((unsigned int)x * 73856093u ^ (unsigned int)y * 19349663u ^ (unsigned int)z * 83492791u) & grid->mask;
+}
+
+static int add_pair(BondWorker *worker, int a, int b)
+{
+    if (worker->count == worker->capacity)
+    {
+        int grown = worker->capacity ? worker->capacity * 2 : 1024;
+        int *tmp = realloc(worker->pairs, (size_t)grown * 2 * sizeof(int));
+        if (!tmp)
+            return -1;
+        worker->pairs = tmp;
+        worker->capacity = grown;
+    }
+    worker->pairs[2 * worker->count] = a;
+    worker->pairs[2 * worker->count + 1] = b;
+    worker->count++;
+    return 0;
+}
+
+static void *find_bonds(void *arg)
+{
+    BondWorker *worker = arg;
+    const BondGrid *grid = worker->grid;
+    const Structure *s = grid->s;
+    const float minDist2 = BONDS_MIN_DISTANCE * BONDS_MIN_DISTANCE;
+
+    for (int i = worker->begin; i < worker->end; i++)
+    {
+        const int *ci = &grid->cell[3 * i];
+        float ri = element_get(s->element[i])->covalent_radius + BONDS_TOLERANCE;
+
+        for (int dz = -1; dz <= 1; dz++)
+        {
+            for (int dy = -1; dy <= 1; dy++)
+            {
+                for (int dx = -1; dx <= 1; dx++)
+                {
+                    int x = ci[0] + dx, y = ci[1] + dy, z = ci[2] + dz;
+                    unsigned int bucket = cell_bucket(grid, x, y, z);
+
+                    for (int k = grid->bucketStart[bucket]; k < grid->bucketStart[bucket + 1]; k++)
+                    {
+                        // each pair once, from its lower atom
+                        int j = grid->atoms[k];
+                        const int *cj = &grid->cell[3 * j];
+                        if (j <= i || cj[0] != x || cj[1] != y || cj[2] != z)
+                            continue;
+
+                        float ex = s->x[j] - s->x[i];
+                        float ey = s->y[j] - s->y[i];
+                        float ez = s->z[j] - s->z[i];
+                        float dist2 = ex * ex + ey * ey + ez * ez;
+                        float cutoff = ri + element_get(s->element[j])->covalent_radius;
+                        if (dist2 > minDist2 && dist2 < cutoff * cutoff && add_pair(worker, i, j) != 0)
+                        {
+                            worker->failed = 1;
+                            return NULL;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+static int grid_init(BondGrid *grid, const Structure *s)
+{
+    int n = s->atom_count;
+    memset(grid, 0, sizeof(BondGrid));
+    grid->s = s;
+
+    // a cell spans the longest bond the present elements can form
+    float maxRadius = 0.0f;
+    float upper[3] = {-INFINITY, -INFINITY, -INFINITY};
+    grid->origin[0] = grid->origin[1] = grid->origin[2] = INFINITY;
+    for (int i = 0; i < n; i++)
+    {
+        float r = element_get(s->element[i])->covalent_radius;
+        if (r > maxRadius)
+            maxRadius = r;
+        grid->origin[0] = fminf(grid->origin[0], s->x[i]);
+        grid->origin[1] = fminf(grid->origin[1], s->y[i]);
+        grid->origin[2] = fminf(grid->origin[2], s->z[i]);
+        upper[0] = fmaxf(upper[0], s->x[i]);
+        upper[1] = fmaxf(upper[1], s->y[i]);
+        upper[2] = fmaxf(upper[2], s->z[i]);
+    }
+    grid->cellInv = 1.0f / (2.0f * maxRadius + BONDS_TOLERANCE);
+
+    // dense grid plus one always empty bucket when it stays small, otherwise hashed
+    double cells = 1.0;
+    for (int a = 0; a < 3 && n > 0; a++)
+    {
+        grid->dims[a] = (int)((upper[a] - grid->origin[a]) * grid->cellInv) + 1;
+        cells *= grid->dims[a];
+    }
+    unsigned int buckets;
+    if (n > 0 && cells <= (double)n * BONDS_DENSE_CELLS_PER_ATOM)
+    {
+        buckets = (unsigned int)cells + 1;
+    }
+    else
+    {
+        memset(grid->dims, 0, sizeof(grid->dims));
+        buckets = 1;
+        while (buckets < (unsigned int)n)
+            buckets <<= 1;
+        grid->mask = buckets - 1;
+    }
+    grid->bucketCount = buckets;
+
+    grid->cell = malloc((size_t)n * 3 * sizeof(int));
+    grid->bucketStart = calloc(buckets + 1, sizeof(int));
+    grid->atoms = malloc((size_t)n * sizeof(int));
+    if (!grid->cell || !grid->bucketStart || !grid->atoms)
+        return -1;
+
+    for (int i = 0; i < n; i++)
+    {
+        int *c = &grid->cell[3 * i];
+        c[0] = (int)((s->x[i] - grid->origin[0]) * grid->cellInv);
+        c[1] = (int)((s->y[i] - grid->origin[1]) * grid->cellInv);
+        c[2] = (int)((s->z[i] - grid->origin[2]) * grid->cellInv);
+        grid->bucketStart[cell_bucket(grid, c[0], c[1], c[2]) + 1]++;
+    }
+    for (unsigned int b = 0; b < buckets; b++)
+    {
+        grid->bucketStart[b + 1] += grid->bucketStart[b];
+    }
+
+    // bucketStart[b] doubles as the fill cursor of bucket b, ending at the start of b + 1 ...
+    for (int i = 0; i < n; i++)
+    {
+        int *c = &grid->cell[3 * i];
+        grid->atoms[grid->bucketStart[cell_bucket(grid, c[0], c[1], c[2])]++] = i;
+    }
+    // ... and is shifted back to the start of bucket b afterwards
+    for (unsigned int b = buckets; b > 0; b--)
+    {
+        grid->bucketStart[b] = grid->bucketStart[b - 1];
+    }
+    grid->bucketStart[0] = 0;
+    return 0;
+}
+
+static void grid_delete(BondGrid *grid)
+{
+    free(grid->cell);
+    free(grid->bucketStart);
+    free(grid->atoms);
+}
+
+int bonds_perceive(Structure *s)
+{
+    int n = s->atom_count;
+
+    BondGrid grid;
+    if (grid_init(&grid, s) != 0)
+    {
+        printf("Memory allocation error for bond perception\n");
+        grid_delete(&grid);
+        return -1;
+    }
+
+    int threadCount = n / BONDS_ATOMS_PER_THREAD;
+    if (threadCount < 1)
+        threadCount = 1;
+    if (threadCount > BONDS_MAX_THREADS)
+        threadCount = BONDS_MAX_THREADS;
+
+    // contiguous atom ranges, the first one runs on this thread
+    BondWorker workers[BONDS_MAX_THREADS];
+    pthread_t threads[BONDS_MAX_THREADS];
+    int started[BONDS_MAX_THREADS] = {0};
+    memset(workers, 0, sizeof(workers));
+    for (int t = 0; t < threadCount; t++)
+    {
+        workers[t].grid = &grid;
+        workers[t].begin = (int)((long long)n * t / threadCount);
+        workers[t].end = (int)((long long)n * (t + 1) / threadCount);
+        if (t > 0)
+            started[t] = pthread_create(&threads[t], NULL, find_bonds, &workers[t]) == 0;
+    }
+    find_bonds(&workers[0]);
+
+    int total = 0;
+    int failed = workers[0].failed;
+    for (int t = 1; t < threadCount; t++)
+    {
+        // a thread that could not start does its share here
+        if (started[t])
+            pthread_join(threads[t], NULL);
+        else
+            find_bonds(&workers[t]);
+        failed |= workers[t].failed;
+    }
+    for (int t = 0; t < threadCount; t++)
+    {
+        total += workers[t].count;
+    }
+
+    if (failed || structure_resizeBonds(s, total) != 0)
+    {
+        printf("Memory allocation error for bond perception\n");
+        total = -1;
+    }
+    else
+    {
+        // in atom order, whatever the thread count
+        int b = 0;
+        for (int t = 0; t < threadCount; t++)
+        {
+            for (int k = 0; k < workers[t].count; k++, b++)
+            {
+                structure_setBond(s, b, workers[t].pairs[2 * k], workers[t].pairs[2 * k + 1], 1);
+            }
+        }
+    }
+
+    for (int t = 0; t < threadCount; t++)
+    {
+        free(workers[t].pairs);
+    }
+    grid_delete(&grid);
+    return total;
+}
@@ -0,0 +1,223 @@
+#include <stdio.h>
+#include <string.h>
+#include <float.h>
+#include <bvh.h>
+
+#define BVH_ALL_PLANES 0x3f
+
+static void sphere_box(const float *sphere, vec3 min, vec3 max)
+{
+    for (int a = 0; a < 3; a++)
+    {
+        min[a] = sphere[a] - sphere[3];
+        max[a] = sphere[a] + sphere[3];
+    }
+}
+
+static void node_fit(const Bvh *bvh, BvhNode *node, const vec4 *spheres)
+{
+    glm_vec3_fill(node->min, FLT_MAX);
+    glm_vec3_fill(node->max, -FLT_MAX);
+    for (int i = node->first; i < node->first + node->count; i++)
+    {
+        vec3 min, max;
+        sphere_box(spheres[bvh->items[i]], min, max);
+        glm_vec3_minv(node->min, min, node->min);
+        glm_vec3_maxv(node->max, max, node->max);
+    }
+}
+
+// reorders items[first, last) so the item with the k-th smallest center on `axis` is at k
+static void select_kth(int *items, int first, int last, int k, const vec4 *spheres, int axis)
+{
+    while (last - first > 1)
+    {
+        float pivot = spheres[items[first + (last - first) / 2]][axis];
+        int i = first, j = last - 1;
+        while (i <= j)
+        {
+            while (spheres[items[i]][axis] < pivot)
+                i++;
+            while (spheres[items[j]][axis] > pivot)
+                j--;
+            if (i <= j)
+            {
+                int tmp = items[i];
+                items[i++] = items[j];
+                items[j--] = tmp;
+            }
+        }
+
+        if (k <= j)
+            last = j + 1;
+        else if (k >= i)
+            first = i;
+        else
+            return;
+    }
+}
+
+int bvh_build(Bvh *bvh, Arena *arena, const vec4 *spheres, int count)
+{
+    memset(bvh, 0, sizeof(Bvh));
+    if (count <= 0)
+        return 0;
+
+    // object median splits leave at least BVH_LEAF_SIZE / 2 items per leaf
+    int maxLeaves = (count + BVH_LEAF_SIZE / 2 - 1) / (BVH_LEAF_SIZE / 2);
+    bvh->nodes = arena_alloc(arena, (2 * maxLeaves - 1) * sizeof(BvhNode));
+    bvh->items = arena_alloc(arena, count * sizeof(int));
+    if (!bvh->nodes || !bvh->items)
+    {
+        printf("Memory allocation error for bounding volume hierarchy\n");
+        memset(bvh, 0, sizeof(Bvh));
+        return -1;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        bvh->items[i] = i;
+    }
+    bvh->item_count = count;
+
+    bvh->nodes[0].first = 0;
+    bvh->nodes[0].count = count;
+    bvh->node_count = 1;
+
+    // split leaves in creation order, so children always follow their parent
+    for (int n = 0; n < bvh->node_count; n++)
+    {
+        BvhNode *node = &bvh->nodes[n];
+        if (node->count <= BVH_LEAF_SIZE)
+            continue;
+
+        // longest axis of the centers
+        vec3 lo, hi;
+        glm_vec3_fill(lo, FLT_MAX);
+        glm_vec3_fill(hi, -FLT_MAX);
+        for (int i = node->first; i < node->first + node->count; i++)
+        {
+            glm_vec3_minv(lo, (float *)spheres[bvh->items[i]], lo);
+            glm_vec3_maxv(hi, (float *)spheres[bvh->items[i]], hi);
+        }
+        int axis = 0;
+        for (int a = 1; a < 3; a++)
+        {
+            if (hi[a] - lo[a] > hi[axis] - lo[axis])
+                axis = a;
+        }
+
+        int first = node->first;
+        int half = node->count / 2;
+        select_kth(bvh->items, first, first + node->count, first + half, spheres, axis);
+
+        BvhNode *left = &bvh->nodes[bvh->node_count];
+        BvhNode *right = &bvh->nodes[bvh->node_count + 1];
+        left->first = first;
+        left->count = half;
+        right->first = first + half;
+        right->count = node->count - half;
+
+        node->first = bvh->node_count;
+        node->count = 0;
+        bvh->node_count += 2;
+    }
+
+    // leaf boxes from their items, inner ones from their children
+    bvh_refit(bvh, spheres);
+    return 0;
+}
+
+void bvh_refit(Bvh *bvh, const vec4 *spheres)
+{
+    for (int n = bvh->node_count - 1; n >= 0; n--)
+    {
+        BvhNode *node = &bvh->nodes[n];
+        if (node->count > 0)
+        {
+            node_fit(bvh, node, spheres);
+        }
+        else
+        {
+            const BvhNode *left = &bvh->nodes[node->first];
+            const BvhNode *right = &bvh->nodes[node->first + 1];
+            glm_vec3_minv((float *)left->min, (float *)right->min, node->min);
+            glm_vec3_maxv((float *)left->max, (float *)right->max, node->max);
+        }
+    }
+}
+
+// planes of `mask` the box is fully inside are cleared, -1 when it is outside one of them
+static int box_planes(const BvhNode *node, vec4 planes[6], int mask)
+{
+    vec3 center, extent;
+    glm_vec3_center((float *)node->min, (float *)node->max, center);
+    glm_vec3_sub((float *)node->max, center, extent);
+
+    for (int p = 0; p < 6; p++)
+    {
+        if (!(mask & (1 << p)))
+            continue;
+
+        float dist = glm_vec3_dot(planes[p], center) + planes[p][3];
+        float reach = fabsf(planes[p][0]) * extent[0] + fabsf(planes[p][1]) * extent[1] + fabsf(planes[p][2]) * extent[2];
+        if (dist < -reach)
+            return -1;
+        if (dist >= reach)
+            mask &= ~(1 << p);
+    }
+    return mask;
+}
+
+static int sphere_visible(const float *sphere, vec4 planes[6], int mask)
+{
+    for (int p = 0; p < 6; p++)
+    {
+        if ((mask & (1 << p)) && glm_vec3_dot(planes[p], (float *)sphere) + planes[p][3] < -sphere[3])
+            return 0;
+    }
+    return 1;
+}
+
+int bvh_cull(const Bvh *bvh, const vec4 *spheres, vec4 planes[6], BvhLeafTest test, void *user, int *visible)
+{
+    if (bvh->node_count == 0)
+        return 0;
+
+    int stack[BVH_STACK_SIZE][2]; // node, planes still intersected
+    int top = 0;
+    int count = 0;
+
+    stack[top][0] = 0;
+    stack[top++][1] = BVH_ALL_PLANES;
+    while (top > 0)
+    {
+        top--;
+        const BvhNode *node = &bvh->nodes[stack[top][0]];
+        int mask = box_planes(node, planes, stack[top][1]);
+        if (mask < 0)
+            continue;
+
+        if (node->count == 0)
+        {
+            for (int c = 1; c >= 0; c--)
+            {
+                stack[top][0] = node->first + c;
+                stack[top++][1] = mask;
+            }
+            continue;
+        }
+
+        if (test && !test(node, user))
+            continue;
+
+        // fully inside: the whole leaf without per-item tests
+        const int *items = &bvh->items[node->first];
+        for (int i = 0; i < node->count; i++)
+        {
+            if (mask == 0 || sphere_visible(spheres[items[i]], planes, mask))
+                visible[count++] = items[i];
+        }
+    }
+    return count;
+}
@@ -0,0 +1,274 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <utime.h>
+#include <sys/stat.h>
+#include <cache.h>
+#include <molbin.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#define make_dir(path) _mkdir(path)
+#define process_id() _getpid()
+#else
+#include <unistd.h>
+#define make_dir(path) mkdir(path, 0755)
+#define process_id() getpid()
+#endif
+
+#define CACHE_PATH_SIZE 512
+#define CACHE_EXT MOLB_EXT
+
+struct ConformerCache
+{
+    char dir[CACHE_PATH_SIZE - 32];
+    long max_bytes;
+
+    pthread_mutex_t lock;
+    CacheStats stats;
+};
+
+typedef struct
+{
+    char name[64];
+    long size;
+    time_t used;
+} CacheEntry;
+
+// FNV-1a, the key ignores surrounding whitespace of the molecule string
+static uint64_t cache_hash(const char *molecule_str, const char *options)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    const char *begin = molecule_str;
+    const char *end = molecule_str + strlen(molecule_str);
+    while (begin < end && isspace((unsigned char)*begin))
+        begin++;
+    while (end > begin && isspace((unsigned char)end[-1]))
+        end--;
+
+    for (const char *c = begin; c < end; c++)
+    {
+        hash ^= (unsigned char)*c;
+        hash *= 0x100000001b3ULL;
+    }
+
+    // separator so "ab" + "c" and "a" + "bc" differ
+    hash ^= 0xff;
+    hash *= 0x100000001b3ULL;
+
+    for (const char *c = options; *c; c++)
+    {
+        hash ^= (unsigned char)*c;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static void cache_path(ConformerCache *cache, const char *molecule_str, const char *options, char *path, size_t size)
+{
+    snprintf(path, size, "%s/%016llx" CACHE_EXT, cache->dir,
+             (unsigned long long)cache_hash(molecule_str, options));
+}
+
+static int by_last_use(const void *a, const void *b)
+{
+    time_t ta = ((const CacheEntry *)a)->used;
+    time_t tb = ((const CacheEntry *)b)->used;
+    return (ta > tb) - (ta < tb);
+}
+
+// removes the least recently used records until the directory fits max_bytes, lock held
+static void cache_evict(ConformerCache *cache)
+{
+    DIR *dir = opendir(cache->dir);
+    if (!dir)
+        return;
+
+    CacheEntry *entries = NULL;
+    size_t count = 0, capacity = 0;
+    long total = 0;
+    char path[sizeof(cache->dir) + sizeof(entries->name) + 1]; // dir/name always fits
+
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL)
+    {
+        size_t len = strlen(ent->d_name);
+        if (len < sizeof(CACHE_EXT) || len >= sizeof(entries->name) ||
+            strcmp(ent->d_name + len - (sizeof(CACHE_EXT) - 1), CACHE_EXT) != 0)
+            continue;
+
+        struct stat st;
+        snprintf(path, sizeof(path), "%s/%s", cache->dir, ent->d_name);
+        if (stat(path, &st) != 0)
+            continue;
+
+        if (count == capacity)
+        {
+            size_t grown = capacity ? capacity * 2 : 64;
+            CacheEntry *tmp = realloc(entries, grown * sizeof(CacheEntry));
+            if (!tmp)
+                break;
+            entries = tmp;
+            capacity = grown;
+        }
+        strcpy(entries[count].name, ent->d_name);
+        entries[count].size = (long)st.st_size;
+        entries[count].used = st.st_mtime; // lookups touch the record, so mtime is the last use
+        total += (long)st.st_size;
+        count++;
+    }
+    closedir(dir);
+
+    qsort(entries, count, sizeof(CacheEntry), by_last_use);
+    for (size_t i = 0; i < count && total > cache->max_bytes; i++)
+    {
+        snprintf(path, sizeof(path), "%s/%s", cache->dir, entries[i].name);
+        if (remove(path) == 0)
+        {
+            total -= entries[i].size;
+            cache->stats.evictions++;
+        }
+    }
+
+    cache->stats.bytes = total;
+    free(entries);
+}
+
+ConformerCache *cache_create(const char *dir, long max_bytes)
+{
+    ConformerCache *cache = calloc(1, sizeof(ConformerCache));
+    if (!cache)
+    {
+        printf("Memory allocation error\n");
+        return NULL;
+    }
+
+    strncpy(cache->dir, dir, sizeof(cache->dir) - 1);
+    cache->dir[sizeof(cache->dir) - 1] = '\0';
+    cache->max_bytes = max_bytes;
+
+    // create the directory and its parents, existing ones are fine
+    char partial[sizeof(cache->dir)];
+    for (size_t i = 1; cache->dir[i - 1]; i++)
+    {
+        if (cache->dir[i] == '/' || cache->dir[i] == '\0')
+        {
+            memcpy(partial, cache->dir, i);
+            partial[i] = '\0';
+            make_dir(partial);
+        }
+    }
+    DIR *check = opendir(cache->dir);
+    if (!check)
+    {
+        printf("Failed to open conformer cache directory %s\n", cache->dir);
+        free(cache);
+        return NULL;
+    }
+    closedir(check);
+
+    // applies a lowered limit right away and fills stats.bytes
+    cache_evict(cache);
+
+    pthread_mutex_init(&cache->lock, NULL);
+    return cache;
+}
+
+int cache_lookup(ConformerCache *cache, const char *molecule_str, const char *options, Molecule *mol)
+{
+    char path[CACHE_PATH_SIZE];
+    cache_path(cache, molecule_str, options, path, sizeof(path));
+
+    pthread_mutex_lock(&cache->lock);
+    // records are binary molecule files, a miss is simply a file that does not exist
+    int result = -1;
+    FILE *probe = fopen(path, "rb");
+    if (probe)
+    {
+        fclose(probe);
+        result = load_molecule_from_binary(path, mol);
+
+        if (result == 0)
+            utime(path, NULL); // mark as recently used
+        else
+            remove(path); // truncated or from an older format
+    }
+
+    if (result == 0)
+        cache->stats.hits++;
+    else
+        cache->stats.misses++;
+    pthread_mutex_unlock(&cache->lock);
+    return result;
+}
+
+int cache_store(ConformerCache *cache, const char *molecule_str, const char *options, const Molecule *mol)
+{
+    char path[CACHE_PATH_SIZE];
+    char tmpPath[CACHE_PATH_SIZE + 32];
+    cache_path(cache, molecule_str, options, path, sizeof(path));
+    // per process, so another instance storing the same conformer never writes into it
+    snprintf(tmpPath, sizeof(tmpPath), "%s.%ld.tmp", path, (long)process_id());
+
+    pthread_mutex_lock(&cache->lock);
+
+    // written aside and renamed, a reader never sees a partial record
+    int result = save_molecule_binary(tmpPath, mol);
+    struct stat st;
+    if (result == 0)
+    {
+        if (stat(path, &st) == 0)
+            cache->stats.bytes -= (long)st.st_size; // replaced
+        remove(path); // rename does not replace an existing file on Windows
+        result = rename(tmpPath, path) == 0 ? 0 : -1;
+    }
+    if (result != 0)
+    {
+        printf("Failed to write conformer cache record %s\n", path);
+        remove(tmpPath);
+    }
+    else
+    {
+        cache->stats.stores++;
+        if (stat(path, &st) == 0)
+            cache->stats.bytes += (long)st.st_size;
+        // the directory is only scanned once the tracked size goes over the limit
+        if (cache->stats.bytes > cache->max_bytes)
+            cache_evict(cache);
+    }
+
+    pthread_mutex_unlock(&cache->lock);
+    return result;
+}
+
+CacheStats cache_getStats(ConformerCache *cache)
+{
+    pthread_mutex_lock(&cache->lock);
+    CacheStats stats = cache->stats;
+    pthread_mutex_unlock(&cache->lock);
+    return stats;
+}
+
+void cache_printStats(ConformerCache *cache)
+{
+    CacheStats stats = cache_getStats(cache);
+    long lookups = stats.hits + stats.misses;
+    printf("Conformer cache %s: %ld hits, %ld misses (%.0f%% hit rate), %ld stored, %ld evicted, %ld / %ld bytes\n",
+           cache->dir, stats.hits, stats.misses, lookups ? 100.0 * stats.hits / lookups : 0.0,
+           stats.stores, stats.evictions, stats.bytes, cache->max_bytes);
+}
+
+void cache_delete(ConformerCache *cache)
+{
+    if (!cache)
+        return;
+
+    pthread_mutex_destroy(&cache->lock);
+    free(cache);
+}
@@ -1,7 +1,8 @@
 #include <cube.h>
 #include <string.h>
 
-void cube_gen_vecs(Cube *cube)
+// fills caller provided (scratch) arrays, the cube keeps only its GL handles
+void cube_gen_vecs(MeshVertex vertices[CUBE_VERTICES], MeshIndex indices[CUBE_INDICES])
 {
     const float base_vertices[24] = {
         // Positions only
@@ -30,7 +31,7 @@ void cube_gen_vecs(Cube *cube)
         // Top face (positive Y)
         0.0f, 1.0f, 0.0f};
 
-    const unsigned int base_indices[36] = {
+    const MeshIndex base_indices[36] = {
         // Front face
         0, 1, 2, 2, 3, 0,
         // Back face
@@ -44,31 +45,26 @@ void cube_gen_vecs(Cube *cube)
         // Top face
         3, 2, 6, 6, 7, 3};
 
-    // position (x, y, z) + color (r, g, b)
+    // position (x, y, z) + normal, the color is a constant attribute (see cube_draw)
     for (int i = 0; i < 8; i++)
     {
-        int vi = i * 9;                                    // 3 for position + 3 for color
-        cube->vertices[vi] = base_vertices[i * 3];         // x
-        cube->vertices[vi + 1] = base_vertices[i * 3 + 1]; // y
-        cube->vertices[vi + 2] = base_vertices[i * 3 + 2]; // z
-        cube->vertices[vi + 3] = cube->color[0];           // r
-        cube->vertices[vi + 4] = cube->color[1];           // g
-        cube->vertices[vi + 5] = cube->color[2];           // b
+        vertex_packPosition((vec3){base_vertices[i * 3], base_vertices[i * 3 + 1], base_vertices[i * 3 + 2]}, vertices[i].position);
 
         int faceIndex = i / 4;
         // TODO: not working
-        cube->vertices[vi + 6] = -base_normals[faceIndex * 3];     // nx
-        cube->vertices[vi + 7] = -base_normals[faceIndex * 3 + 1]; // ny
-        cube->vertices[vi + 8] = -base_normals[faceIndex * 3 + 2]; // nz
+        vec3 normal = {-base_normals[faceIndex * 3], -base_normals[faceIndex * 3 + 1], -base_normals[faceIndex * 3 + 2]};
+        vertices[i].normal = vertex_packNormal(normal);
     }
 
-    memcpy(cube->indices, base_indices, sizeof(base_indices));
+    memcpy(indices, base_indices, sizeof(base_indices));
 }
 
 void cube_init(Cube *cube, vec3 position, vec3 color, float scale)
 {
+    MeshVertex vertices[CUBE_VERTICES];
+    MeshIndex indices[CUBE_INDICES];
+    cube_gen_vecs(vertices, indices);
     glm_vec3_copy(color, cube->color);
-    cube_gen_vecs(cube);
     glm_vec3_copy(position, cube->position);
     cube->scale = scale;
 
@@ -79,27 +75,18 @@ void cube_init(Cube *cube, vec3 position, vec3 color, float scale)
     glBindVertexArray(cube->VAO);
 
     glBindBuffer(GL_ARRAY_BUFFER, cube->VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cube->vertices), cube->vertices, GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cube->EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube->indices), cube->indices, GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
 
-    // position(x, y, z)
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(0);
-
-    // color(r,b, g)
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void *)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    // normals(nx, ny, nz)
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void *)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
+    vertex_bindMesh();
+    glBindVertexArray(0);
 };
 
-void cube_draw(Cube *cube, Shader *sh, mat4 view, mat4 projection)
+void cube_draw(Cube *cube, Shader *sh)
 {
-    glUseProgram(sh->ID);
+    shader_use(sh);
 
     mat4 model;
     glm_mat4_identity(model);
@@ -108,19 +95,13 @@ void cube_draw(Cube *cube, Shader *sh, mat4 view, mat4 projection)
     glm_scale(model, (vec3){cube->scale, cube->scale, cube->scale});
     glm_rotate(model, glm_rad(55.0f), (vec3){0.0f, 1.0f, 0.0f});
 
-    mat4 result;
-    // order matters
-    glm_mat4_mul(view, model, result);
-    glm_mat4_mul(projection, result, result);
-
-    unsigned int modelLoc = glGetUniformLocation(sh->ID, "model");
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, (const GLfloat *)model);
+    shader_setUniformMat4(sh, SHADER_UNIFORM_MODEL, model);
 
-    unsigned int transformLoc = glGetUniformLocation(sh->ID, "transform");
-    glUniformMatrix4fv(transformLoc, 1, GL_FALSE, (const GLfloat *)result);
+    // attribute 1 has no array, every vertex reads this color
+    glVertexAttrib4f(1, cube->color[0], cube->color[1], cube->color[2], 1.0f);
 
     glBindVertexArray(cube->VAO);
-    glDrawElements(GL_TRIANGLES, CUBE_INDICES, GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES, CUBE_INDICES, MESH_INDEX_TYPE, 0);
     glBindVertexArray(0);
 };
 
@@ -1,142 +1,116 @@
+#include <stdlib.h>
 #include <cylinder.h>
+#include <meshopt.h>
 
-void cylinder_gen_sectors(Cylinder *cylinder)
+void cylinder_gen_sectors(Cylinder *cylinder, MeshVertex *vertices)
 {
-    const float sectorStep = 2 * CY_PI / CY_SECTOR_COUNT;
+    const float sectorStep = 2 * CY_PI / cylinder->sectors;
     int vi = 0;
 
-    // for lateral surface
-    for (int j = 0; j <= CY_SECTOR_COUNT; j++)
+    // for lateral surface, top ring followed by bottom ring
+    for (int i = 0; i < 2; i++)
     {
-        float sectorAngle = j * sectorStep;
-        float x = cylinder->radius * cos(sectorAngle);
-        float y = cylinder->radius * sin(sectorAngle);
+        float z = (1 - 2 * i) * 0.5f; // Top and bottom of the side
 
-        for (int i = 0; i < 2; i++)
+        for (int j = 0; j <= cylinder->sectors; j++)
         {
-            float z = (1 - 2 * i) * (cylinder->height / 2); // Top and bottom of the side
+            float sectorAngle = j * sectorStep;
+            float x = cos(sectorAngle);
+            float y = sin(sectorAngle);
 
-            cylinder->vertices[vi++] = x;
-            cylinder->vertices[vi++] = y;
-            cylinder->vertices[vi++] = z;
+            vertex_packPosition((vec3){x, y, z}, vertices[vi].position);
 
-            cylinder->vertices[vi++] = cylinder->color[0];
-            cylinder->vertices[vi++] = cylinder->color[1];
-            cylinder->vertices[vi++] = cylinder->color[2];
-
-            // Normals (side)
-            float lengthInv = -1.0f / cylinder->radius;
-            cylinder->vertices[vi++] = x * lengthInv;
-            cylinder->vertices[vi++] = y * lengthInv;
-            cylinder->vertices[vi++] = 0.0f;
+            // Normals (side, inward facing like the sphere)
+            vertices[vi].normal = vertex_packNormal((vec3){-x, -y, 0.0f});
+            vi++;
         }
     }
 };
 
-void cylinder_gen_indices(Cylinder *cylinder)
+void cylinder_gen_indices(Cylinder *cylinder, MeshIndex *indices)
 {
     int vi = 0;
 
-    for (int k1 = 0; k1 < CY_SECTOR_COUNT; k1++)
+    for (int k1 = 0; k1 < cylinder->sectors; k1++)
     {
-        int k2 = k1 + CY_SECTOR_COUNT + 1;
+        int k2 = k1 + cylinder->sectors + 1;
         // top triangle
-        cylinder->indices[vi++] = k1;
-        cylinder->indices[vi++] = k2;
-        cylinder->indices[vi++] = k1 + 1;
+        indices[vi++] = k1;
+        indices[vi++] = k2;
+        indices[vi++] = k1 + 1;
 
         // bottom triangle
-        cylinder->indices[vi++] = k1 + 1;
-        cylinder->indices[vi++] = k2;
-        cylinder->indices[vi++] = k2 + 1;
+        indices[vi++] = k1 + 1;
+        indices[vi++] = k2;
+        indices[vi++] = k2 + 1;
     };
+
+    cylinder->index_count = vi;
 };
 
-void cylinder_init(Cylinder *cylinder, vec3 position, vec3 direction, vec3 color, float radius, float height)
+void cylinder_init(Cylinder *cylinder, int sectors)
 {
-    glm_vec3_copy(position, cylinder->position);
-    glm_vec3_copy(direction, cylinder->direction);
-    glm_vec3_copy(color, cylinder->color);
-    cylinder->radius = radius;
-    cylinder->height = height;
-    cylinder->angle = 0.0f;
+    cylinder->sectors = glm_clamp(sectors, 3, CY_SECTOR_COUNT);
 
-    cylinder_gen_sectors(cylinder);
-    cylinder_gen_indices(cylinder);
+    // transient, the GPU keeps the only copy
+    size_t vertexBytes = CYLINDER_VERTEX_COUNT(cylinder->sectors) * sizeof(MeshVertex);
+    size_t indexBytes = CYLINDER_INDEX_COUNT(cylinder->sectors) * sizeof(MeshIndex);
+    char *scratch = malloc(vertexBytes + indexBytes);
+    if (!scratch)
+    {
+        printf("Memory allocation error for cylinder mesh\n");
+        return;
+    }
+    MeshVertex *vertices = (MeshVertex *)scratch;
+    MeshIndex *indices = (MeshIndex *)(scratch + vertexBytes);
+
+    cylinder_gen_sectors(cylinder, vertices);
+    cylinder_gen_indices(cylinder, indices);
+
+    // drawn once per instance, so reorder for the post-transform cache and then for fetch locality;
+    // the side quads already go around in cache order, Tipsify leaves their ACMR unchanged
+    int vertexCount = CYLINDER_VERTEX_COUNT(cylinder->sectors);
+#ifdef MESHOPT_VERBOSE
+    float acmrBefore = meshopt_acmr(indices, cylinder->index_count, vertexCount, MESHOPT_CACHE_SIZE);
+#endif
+    if (meshopt_optimizeCache(indices, cylinder->index_count, vertexCount, MESHOPT_CACHE_SIZE) == 0)
+        meshopt_optimizeFetch(vertices, sizeof(MeshVertex), vertexCount, indices, cylinder->index_count);
+#ifdef MESHOPT_VERBOSE
+    printf("Cylinder %d ACMR %.3f -> %.3f\n", cylinder->sectors, acmrBefore,
+           meshopt_acmr(indices, cylinder->index_count, vertexCount, MESHOPT_CACHE_SIZE));
+#endif
 
-    glGenVertexArrays(1, &cylinder->VAO);
     glGenBuffers(1, &cylinder->VBO);
     glGenBuffers(1, &cylinder->EBO);
 
-    glBindVertexArray(cylinder->VAO);
-
-    if (!cylinder->VAO || !cylinder->VBO || !cylinder->EBO)
+    if (!cylinder->VBO || !cylinder->EBO)
     {
-        printf("Error generating VAO/VBO/EBO\n");
+        printf("Error generating VBO/EBO\n");
+        free(scratch);
         return;
     }
 
     glBindBuffer(GL_ARRAY_BUFFER, cylinder->VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cylinder->vertices), cylinder->vertices, GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, vertexBytes, vertices, GL_STATIC_DRAW);
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cylinder->EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cylinder->indices), cylinder->indices, GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, cylinder->index_count * sizeof(MeshIndex), indices, GL_STATIC_DRAW);
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void *)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void *)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-};
-
-void cylinder_setAngle(Cylinder *cylinder, float angle)
-{
-    cylinder->angle = angle;
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    free(scratch);
 };
 
-void cylinder_draw(Cylinder *cylinder, Shader *sh, mat4 view, mat4 projection)
+void cylinder_bind(Cylinder *cylinder)
 {
-    glUseProgram(sh->ID);
-
-    mat4 model;
-    glm_mat4_identity(model);
-    glm_rotate_y(model, glm_rad(cylinder->angle), model);
-    glm_translate(model, cylinder->position);
-
-    vec3 z_axis = {0.0f, 0.0f, 1.0f};
-    vec3 rotation_axis;
-    glm_vec3_cross(z_axis, cylinder->direction, rotation_axis);
-
-    float angle = acosf(glm_vec3_dot(z_axis, cylinder->direction));
-    if (glm_vec3_norm(rotation_axis) > 0.001f) // Avoid zero division
-    {
-        glm_vec3_normalize(rotation_axis);
-        mat4 rotation;
-        glm_rotate(model, angle, rotation_axis);
-    }
-
-    mat4 result;
-    // order matters
-    glm_mat4_mul(view, model, result);
-    glm_mat4_mul(projection, result, result);
-
-    unsigned int modelLoc = glGetUniformLocation(sh->ID, "model");
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, (const GLfloat *)model);
-
-    unsigned int transformLoc = glGetUniformLocation(sh->ID, "transform");
-    glUniformMatrix4fv(transformLoc, 1, GL_FALSE, (const GLfloat *)result);
+    glBindBuffer(GL_ARRAY_BUFFER, cylinder->VBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cylinder->EBO);
 
-    glBindVertexArray(cylinder->VAO);
-    glDrawElements(GL_TRIANGLES, sizeof(cylinder->indices) / sizeof(unsigned int), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
-}
+    vertex_bindMesh();
+};
 
 void cylinder_delete(Cylinder *cylinder)
 {
-    glDeleteVertexArrays(1, &cylinder->VAO);
     glDeleteBuffers(1, &cylinder->VBO);
     glDeleteBuffers(1, &cylinder->EBO);
-};
\ No newline at end of file
+};
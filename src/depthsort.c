@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <string.h>
+#include <float.h>
+#include <radix.h>
+#include <depthsort.h>
+
+int depthsort_init(DepthSort *sort, Arena *arena, int count)
+{
+    memset(sort, 0, sizeof(DepthSort));
+    if (count <= 0)
+        return 0;
+
+    sort->order = arena_alloc(arena, count * sizeof(int));
+    sort->rank = arena_alloc(arena, count * sizeof(unsigned int));
+    sort->keys = arena_alloc(arena, count * sizeof(unsigned int));
+    sort->scratch_keys = arena_alloc(arena, count * sizeof(unsigned int));
+    sort->scratch_items = arena_alloc(arena, count * sizeof(int));
+    if (!sort->order || !sort->rank || !sort->keys || !sort->scratch_keys || !sort->scratch_items)
+    {
+        printf("Memory allocation error for depth sorting\n");
+        memset(sort, 0, sizeof(DepthSort));
+        return -1;
+    }
+
+    sort->count = count;
+    while (sort->rank_bits < 32 && (unsigned int)(count - 1) >> sort->rank_bits)
+        sort->rank_bits++;
+    return 0;
+}
+
+int depthsort_update(DepthSort *sort, const vec4 *spheres, mat4 modelView)
+{
+    if (sort->count == 0)
+        return 0;
+
+    // view depth = -(third row of modelView) . p + const, so that row is the direction
+    vec3 direction = {-modelView[0][2], -modelView[1][2], -modelView[2][2]};
+    glm_vec3_normalize(direction);
+    if (sort->valid && glm_vec3_dot(direction, sort->direction) >= cosf(glm_rad(DEPTHSORT_MAX_ANGLE)))
+        return 0;
+
+    float nearest = FLT_MAX, farthest = -FLT_MAX;
+    for (int i = 0; i < sort->count; i++)
+    {
+        float depth = glm_vec3_dot(direction, (float *)spheres[i]);
+        nearest = fminf(nearest, depth);
+        farthest = fmaxf(farthest, depth);
+    }
+
+    float scale = farthest > nearest ? ((1 << DEPTHSORT_KEY_BITS) - 1) / (farthest - nearest) : 0.0f;
+    for (int i = 0; i < sort->count; i++)
+    {
+        sort->keys[i] = (unsigned int)((glm_vec3_dot(direction, (float *)spheres[i]) - nearest) * scale);
+        sort->order[i] = i;
+    }
+    radix_sort(sort->keys, sort->order, sort->scratch_keys, sort->scratch_items, sort->count, DEPTHSORT_KEY_BITS);
+
+    for (int k = 0; k < sort->count; k++)
+    {
+        sort->rank[sort->order[k]] = k;
+    }
+
+    glm_vec3_copy(direction, sort->direction);
+    sort->valid = 1;
+    return 1;
+}
+
+void depthsort_apply(DepthSort *sort, int *visible, int count)
+{
+    if (!sort->valid)
+        return;
+
+    for (int k = 0; k < count; k++)
+    {
+        sort->keys[k] = sort->rank[visible[k]];
+    }
+    radix_sort(sort->keys, visible, sort->scratch_keys, sort->scratch_items, count, sort->rank_bits);
+}
@@ -0,0 +1,219 @@
+#include <ctype.h>
+#include <element.h>
+
+// Colors are Jmol's (elements past Mt reuse Mt's), masses are IUPAC standard atomic weights
+// (mass number of the longest-lived isotope when there is none), covalent radii are
+// Cordero et al. 2008 up to Cm and Pyykko 2009 after it, van der Waals radii are Bondi 1964
+// with Mantina et al. 2009 for main group elements Bondi lacks, 2.0 where neither has data.
+static const Element elements[ELEMENT_COUNT] = {
+    // symbol, color, mass, vdw, covalent, ionic
+    {"?", {0xFF, 0x14, 0x93}, 0.0f, 1.5f, 0.7f, 0.0f},
+    {"H", {0xFF, 0xFF, 0xFF}, 1.008f, 1.1f, 0.31f, 0.0f},
+    {"He", {0xD9, 0xFF, 0xFF}, 4.0026f, 1.4f, 0.28f, 0.0f},
+    {"Li", {0xCC, 0x80, 0xFF}, 6.94f, 1.81f, 1.28f, 0.76f},
+    {"Be", {0xC2, 0xFF, 0x00}, 9.0122f, 1.53f, 0.96f, 0.45f},
+    {"B", {0xFF, 0xB5, 0xB5}, 10.81f, 1.92f, 0.84f, 0.27f},
+    {"C", {0x90, 0x90, 0x90}, 12.011f, 1.7f, 0.76f, 0.16f},
+    {"N", {0x30, 0x50, 0xF8}, 14.007f, 1.55f, 0.71f, 1.46f},
+    {"O", {0xFF, 0x0D, 0x0D}, 15.999f, 1.52f, 0.66f, 1.4f},
+    {"F", {0x90, 0xE0, 0x50}, 18.998f, 1.47f, 0.57f, 1.33f},
+    {"Ne", {0xB3, 0xE3, 0xF5}, 20.18f, 1.54f, 0.58f, 0.0f},
+    {"Na", {0xAB, 0x5C, 0xF2}, 22.99f, 2.27f, 1.66f, 1.02f},
+    {"Mg", {0x8A, 0xFF, 0x00}, 24.305f, 1.73f, 1.41f, 0.72f},
+    {"Al", {0xBF, 0xA6, 0xA6}, 26.982f, 1.84f, 1.21f, 0.535f},
+    {"Si", {0xF0, 0xC8, 0xA0}, 28.085f, 2.1f, 1.11f, 0.4f},
+    {"P", {0xFF, 0x80, 0x00}, 30.974f, 1.8f, 1.07f, 0.38f},
+    {"S", {0xFF, 0xFF, 0x30}, 32.06f, 1.8f, 1.05f, 1.84f},
+    {"Cl", {0x1F, 0xF0, 0x1F}, 35.45f, 1.75f, 1.02f, 1.81f},
+    {"Ar", {0x80, 0xD1, 0xE3}, 39.948f, 1.88f, 1.06f, 0.0f},
+    {"K", {0x8F, 0x40, 0xD4}, 39.098f, 2.75f, 2.03f, 1.38f},
+    {"Ca", {0x3D, 0xFF, 0x00}, 40.078f, 2.31f, 1.76f, 1.0f},
+    {"Sc", {0xE6, 0xE6, 0xE6}, 44.956f, 2.0f, 1.7f, 0.745f},
+    {"Ti", {0xBF, 0xC2, 0xC7}, 47.867f, 2.0f, 1.6f, 0.605f},
+    {"V", {0xA6, 0xA6, 0xAB}, 50.942f, 2.0f, 1.53f, 0.64f},
+    {"Cr", {0x8A, 0x99, 0xC7}, 51.996f, 2.0f, 1.39f, 0.615f},
+    {"Mn", {0x9C, 0x7A, 0xC7}, 54.938f, 2.0f, 1.39f, 0.83f},
+    {"Fe", {0xE0, 0x66, 0x33}, 55.845f, 2.0f, 1.32f, 0.78f},
+    {"Co", {0xF0, 0x90, 0xA0}, 58.933f, 2.0f, 1.26f, 0.745f},
+    {"Ni", {0x50, 0xD0, 0x50}, 58.693f, 1.63f, 1.24f, 0.69f},
+    {"Cu", {0xC8, 0x80, 0x33}, 63.546f, 1.4f, 1.32f, 0.73f},
+    {"Zn", {0x7D, 0x80, 0xB0}, 65.38f, 1.39f, 1.22f, 0.74f},
+    {"Ga", {0xC2, 0x8F, 0x8F}, 69.723f, 1.87f, 1.22f, 0.62f},
+    {"Ge", {0x66, 0x8F, 0x8F}, 72.63f, 2.11f, 1.2f, 0.53f},
+    {"As", {0xBD, 0x80, 0xE3}, 74.922f, 1.85f, 1.19f, 0.58f},
+    {"Se", {0xFF, 0xA1, 0x00}, 78.971f, 1.9f, 1.2f, 1.98f},
+    {"Br", {0xA6, 0x29, 0x29}, 79.904f, 1.83f, 1.2f, 1.96f},
+    {"Kr", {0x5C, 0xB8, 0xD1}, 83.798f, 2.02f, 1.16f, 0.0f},
+    {"Rb", {0x70, 0x2E, 0xB0}, 85.468f, 3.03f, 2.2f, 1.52f},
+    {"Sr", {0x00, 0xFF, 0x00}, 87.62f, 2.49f, 1.95f, 1.18f},
+    {"Y", {0x94, 0xFF, 0xFF}, 88.906f, 2.0f, 1.9f, 0.9f},
+    {"Zr", {0x94, 0xE0, 0xE0}, 91.224f, 2.0f, 1.75f, 0.72f},
+    {"Nb", {0x73, 0xC2, 0xC9}, 92.906f, 2.0f, 1.64f, 0.64f},
+    {"Mo", {0x54, 0xB5, 0xB5}, 95.95f, 2.0f, 1.54f, 0.59f},
+    {"Tc", {0x3B, 0x9E, 0x9E}, 98.0f, 2.0f, 1.47f, 0.645f},
+    {"Ru", {0x24, 0x8F, 0x8F}, 101.07f, 2.0f, 1.46f, 0.68f},
+    {"Rh", {0x0A, 0x7D, 0x8C}, 102.91f, 2.0f, 1.42f, 0.665f},
+    {"Pd", {0x00, 0x69, 0x85}, 106.42f, 1.63f, 1.39f, 0.86f},
+    {"Ag", {0xC0, 0xC0, 0xC0}, 107.87f, 1.72f, 1.45f, 1.15f},
+    {"Cd", {0xFF, 0xD9, 0x8F}, 112.41f, 1.58f, 1.44f, 0.95f},
+    {"In", {0xA6, 0x75, 0x73}, 114.82f, 1.93f, 1.42f, 0.8f},
+    {"Sn", {0x66, 0x80, 0x80}, 118.71f, 2.17f, 1.39f, 0.69f},
+    {"Sb", {0x9E, 0x63, 0xB5}, 121.76f, 2.06f, 1.39f, 0.76f},
+    {"Te", {0xD4, 0x7A, 0x00}, 127.6f, 2.06f, 1.38f, 2.21f},
+    {"I", {0x94, 0x00, 0x94}, 126.9f, 1.98f, 1.39f, 2.2f},
+    {"Xe", {0x42, 0x9E, 0xB0}, 131.29f, 2.16f, 1.4f, 0.0f},
+    {"Cs", {0x57, 0x17, 0x8F}, 132.91f, 3.43f, 2.44f, 1.67f},
+    {"Ba", {0x00, 0xC9, 0x00}, 137.33f, 2.68f, 2.15f, 1.35f},
+    {"La", {0x70, 0xD4, 0xFF}, 138.91f, 2.0f, 2.07f, 1.032f},
+    {"Ce", {0xFF, 0xFF, 0xC7}, 140.12f, 2.0f, 2.04f, 1.01f},
+    {"Pr", {0xD9, 0xFF, 0xC7}, 140.91f, 2.0f, 2.03f, 0.99f},
+    {"Nd", {0xC7, 0xFF, 0xC7}, 144.24f, 2.0f, 2.01f, 0.983f},
+    {"Pm", {0xA3, 0xFF, 0xC7}, 145.0f, 2.0f, 1.99f, 0.97f},
+    {"Sm", {0x8F, 0xFF, 0xC7}, 150.36f, 2.0f, 1.98f, 0.958f},
+    {"Eu", {0x61, 0xFF, 0xC7}, 151.96f, 2.0f, 1.98f, 0.947f},
+    {"Gd", {0x45, 0xFF, 0xC7}, 157.25f, 2.0f, 1.96f, 0.938f},
+    {"Tb", {0x30, 0xFF, 0xC7}, 158.93f, 2.0f, 1.94f, 0.923f},
+    {"Dy", {0x1F, 0xFF, 0xC7}, 162.5f, 2.0f, 1.92f, 0.912f},
+    {"Ho", {0x00, 0xFF, 0x9C}, 164.93f, 2.0f, 1.92f, 0.901f},
+    {"Er", {0x00, 0xE6, 0x75}, 167.26f, 2.0f, 1.89f, 0.89f},
+    {"Tm", {0x00, 0xD4, 0x52}, 168.93f, 2.0f, 1.9f, 0.88f},
+    {"Yb", {0x00, 0xBF, 0x38}, 173.05f, 2.0f, 1.87f, 0.868f},
+    {"Lu", {0x00, 0xAB, 0x24}, 174.97f, 2.0f, 1.87f, 0.861f},
+    {"Hf", {0x4D, 0xC2, 0xFF}, 178.49f, 2.0f, 1.75f, 0.71f},
+    {"Ta", {0x4D, 0xA6, 0xFF}, 180.95f, 2.0f, 1.7f, 0.64f},
+    {"W", {0x21, 0x94, 0xD6}, 183.84f, 2.0f, 1.62f, 0.6f},
+    {"Re", {0x26, 0x7D, 0xAB}, 186.21f, 2.0f, 1.51f, 0.63f},
+    {"Os", {0x26, 0x66, 0x96}, 190.23f, 2.0f, 1.44f, 0.63f},
+    {"Ir", {0x17, 0x54, 0x87}, 192.22f, 2.0f, 1.41f, 0.68f},
+    {"Pt", {0xD0, 0xD0, 0xE0}, 195.08f, 1.75f, 1.36f, 0.8f},
+    {"Au", {0xFF, 0xD1, 0x23}, 196.97f, 1.66f, 1.36f, 1.37f},
+    {"Hg", {0xB8, 0xB8, 0xD0}, 200.59f, 1.55f, 1.32f, 1.02f},
+    {"Tl", {0xA6, 0x54, 0x4D}, 204.38f, 1.96f, 1.45f, 1.5f},
+    {"Pb", {0x57, 0x59, 0x61}, 207.2f, 2.02f, 1.46f, 1.19f},
+    {"Bi", {0x9E, 0x4F, 0xB5}, 208.98f, 2.07f, 1.48f, 1.03f},
+    {"Po", {0xAB, 0x5C, 0x00}, 209.0f, 1.97f, 1.4f, 0.94f},
+    {"At", {0x75, 0x4F, 0x45}, 210.0f, 2.02f, 1.5f, 0.62f},
+    {"Rn", {0x42, 0x82, 0x96}, 222.0f, 2.2f, 1.5f, 0.0f},
+    {"Fr", {0x42, 0x00, 0x66}, 223.0f, 3.48f, 2.6f, 1.8f},
+    {"Ra", {0x00, 0x7D, 0x00}, 226.0f, 2.83f, 2.21f, 1.48f},
+    {"Ac", {0x70, 0xAB, 0xFA}, 227.0f, 2.0f, 2.15f, 1.12f},
+    {"Th", {0x00, 0xBA, 0xFF}, 232.04f, 2.0f, 2.06f, 0.94f},
+    {"Pa", {0x00, 0xA1, 0xFF}, 231.04f, 2.0f, 2.0f, 0.78f},
+    {"U", {0x00, 0x8F, 0xFF}, 238.03f, 1.86f, 1.96f, 0.89f},
+    {"Np", {0x00, 0x80, 0xFF}, 237.0f, 2.0f, 1.9f, 0.87f},
+    {"Pu", {0x00, 0x6B, 0xFF}, 244.0f, 2.0f, 1.87f, 0.86f},
+    {"Am", {0x54, 0x5C, 0xF2}, 243.0f, 2.0f, 1.8f, 0.975f},
+    {"Cm", {0x78, 0x5C, 0xE3}, 247.0f, 2.0f, 1.69f, 0.97f},
+    {"Bk", {0x8A, 0x4F, 0xE3}, 247.0f, 2.0f, 1.68f, 0.96f},
+    {"Cf", {0xA1, 0x36, 0xD4}, 251.0f, 2.0f, 1.68f, 0.95f},
+    {"Es", {0xB3, 0x1F, 0xD4}, 252.0f, 2.0f, 1.65f, 0.0f},
+    {"Fm", {0xB3, 0x1F, 0xBA}, 257.0f, 2.0f, 1.67f, 0.0f},
+    {"Md", {0xB3, 0x0D, 0xA6}, 258.0f, 2.0f, 1.73f, 0.0f},
+    {"No", {0xBD, 0x0D, 0x87}, 259.0f, 2.0f, 1.76f, 0.0f},
+    {"Lr", {0xC7, 0x00, 0x66}, 266.0f, 2.0f, 1.61f, 0.0f},
+    {"Rf", {0xCC, 0x00, 0x59}, 267.0f, 2.0f, 1.57f, 0.0f},
+    {"Db", {0xD1, 0x00, 0x4F}, 268.0f, 2.0f, 1.49f, 0.0f},
+    {"Sg", {0xD9, 0x00, 0x45}, 269.0f, 2.0f, 1.43f, 0.0f},
+    {"Bh", {0xE0, 0x00, 0x38}, 270.0f, 2.0f, 1.41f, 0.0f},
+    {"Hs", {0xE6, 0x00, 0x2E}, 277.0f, 2.0f, 1.34f, 0.0f},
+    {"Mt", {0xEB, 0x00, 0x26}, 278.0f, 2.0f, 1.29f, 0.0f},
+    {"Ds", {0xEB, 0x00, 0x26}, 281.0f, 2.0f, 1.28f, 0.0f},
+    {"Rg", {0xEB, 0x00, 0x26}, 282.0f, 2.0f, 1.21f, 0.0f},
+    {"Cn", {0xEB, 0x00, 0x26}, 285.0f, 2.0f, 1.22f, 0.0f},
+    {"Nh", {0xEB, 0x00, 0x26}, 286.0f, 2.0f, 1.36f, 0.0f},
+    {"Fl", {0xEB, 0x00, 0x26}, 289.0f, 2.0f, 1.43f, 0.0f},
+    {"Mc", {0xEB, 0x00, 0x26}, 290.0f, 2.0f, 1.62f, 0.0f},
+    {"Lv", {0xEB, 0x00, 0x26}, 293.0f, 2.0f, 1.75f, 0.0f},
+    {"Ts", {0xEB, 0x00, 0x26}, 294.0f, 2.0f, 1.65f, 0.0f},
+    {"Og", {0xEB, 0x00, 0x26}, 294.0f, 2.0f, 1.57f, 0.0f},
+};
+
+// two-character symbol index: uppercase first letter, optional lowercase second letter
+#define SYMBOL_SLOT(first, second) (((first) - 'A') * 27 + ((second) ? (second) - 'a' + 1 : 0))
+#define SYMBOL_SLOTS (26 * 27)
+
+static const unsigned char symbolIndex[SYMBOL_SLOTS] = {
+    [SYMBOL_SLOT('H', 0)] = 1, [SYMBOL_SLOT('H', 'e')] = 2, [SYMBOL_SLOT('L', 'i')] = 3,
+    [SYMBOL_SLOT('B', 'e')] = 4, [SYMBOL_SLOT('B', 0)] = 5, [SYMBOL_SLOT('C', 0)] = 6,
+    [SYMBOL_SLOT('N', 0)] = 7, [SYMBOL_SLOT('O', 0)] = 8, [SYMBOL_SLOT('F', 0)] = 9,
+    [SYMBOL_SLOT('N', 'e')] = 10, [SYMBOL_SLOT('N', 'a')] = 11, [SYMBOL_SLOT('M', 'g')] = 12,
+    [SYMBOL_SLOT('A', 'l')] = 13, [SYMBOL_SLOT('S', 'i')] = 14, [SYMBOL_SLOT('P', 0)] = 15,
+    [SYMBOL_SLOT('S', 0)] = 16, [SYMBOL_SLOT('C', 'l')] = 17, [SYMBOL_SLOT('A', 'r')] = 18,
+    [SYMBOL_SLOT('K', 0)] = 19, [SYMBOL_SLOT('C', 'a')] = 20, [SYMBOL_SLOT('S', 'c')] = 21,
+    [SYMBOL_SLOT('T', 'i')] = 22, [SYMBOL_SLOT('V', 0)] = 23, [SYMBOL_SLOT('C', 'r')] = 24,
+    [SYMBOL_SLOT('M', 'n')] = 25, [SYMBOL_SLOT('F', 'e')] = 26, [SYMBOL_SLOT('C', 'o')] = 27,
+    [SYMBOL_SLOT('N', 'i')] = 28, [SYMBOL_SLOT('C', 'u')] = 29, [SYMBOL_SLOT('Z', 'n')] = 30,
+    [SYMBOL_SLOT('G', 'a')] = 31, [SYMBOL_SLOT('G', 'e')] = 32, [SYMBOL_SLOT('A', 's')] = 33,
+    [SYMBOL_SLOT('S', 'e')] = 34, [SYMBOL_SLOT('B', 'r')] = 35, [SYMBOL_SLOT('K', 'r')] = 36,
+    [SYMBOL_SLOT('R', 'b')] = 37, [SYMBOL_SLOT('S', 'r')] = 38, [SYMBOL_SLOT('Y', 0)] = 39,
+    [SYMBOL_SLOT('Z', 'r')] = 40, [SYMBOL_SLOT('N', 'b')] = 41, [SYMBOL_SLOT('M', 'o')] = 42,
+    [SYMBOL_SLOT('T', 'c')] = 43, [SYMBOL_SLOT('R', 'u')] = 44, [SYMBOL_SLOT('R', 'h')] = 45,
+    [SYMBOL_SLOT('P', 'd')] = 46, [SYMBOL_SLOT('A', 'g')] = 47, [SYMBOL_SLOT('C', 'd')] = 48,
+    [SYMBOL_SLOT('I', 'n')] = 49, [SYMBOL_SLOT('S', 'n')] = 50, [SYMBOL_SLOT('S', 'b')] = 51,
+    [SYMBOL_SLOT('T', 'e')] = 52, [SYMBOL_SLOT('I', 0)] = 53, [SYMBOL_SLOT('X', 'e')] = 54,
+    [SYMBOL_SLOT('C', 's')] = 55, [SYMBOL_SLOT('B', 'a')] = 56, [SYMBOL_SLOT('L', 'a')] = 57,
+    [SYMBOL_SLOT('C', 'e')] = 58, [SYMBOL_SLOT('P', 'r')] = 59, [SYMBOL_SLOT('N', 'd')] = 60,
+    [SYMBOL_SLOT('P', 'm')] = 61, [SYMBOL_SLOT('S', 'm')] = 62, [SYMBOL_SLOT('E', 'u')] = 63,
+    [SYMBOL_SLOT('G', 'd')] = 64, [SYMBOL_SLOT('T', 'b')] = 65, [SYMBOL_SLOT('D', 'y')] = 66,
+    [SYMBOL_SLOT('H', 'o')] = 67, [SYMBOL_SLOT('E', 'r')] = 68, [SYMBOL_SLOT('T', 'm')] = 69,
+    [SYMBOL_SLOT('Y', 'b')] = 70, [SYMBOL_SLOT('L', 'u')] = 71, [SYMBOL_SLOT('H', 'f')] = 72,
+    [SYMBOL_SLOT('T', 'a')] = 73, [SYMBOL_SLOT('W', 0)] = 74, [SYMBOL_SLOT('R', 'e')] = 75,
+    [SYMBOL_SLOT('O', 's')] = 76, [SYMBOL_SLOT('I', 'r')] = 77, [SYMBOL_SLOT('P', 't')] = 78,
+    [SYMBOL_SLOT('A', 'u')] = 79, [SYMBOL_SLOT('H', 'g')] = 80, [SYMBOL_SLOT('T', 'l')] = 81,
+    [SYMBOL_SLOT('P', 'b')] = 82, [SYMBOL_SLOT('B', 'i')] = 83, [SYMBOL_SLOT('P', 'o')] = 84,
+    [SYMBOL_SLOT('A', 't')] = 85, [SYMBOL_SLOT('R', 'n')] = 86, [SYMBOL_SLOT('F', 'r')] = 87,
+    [SYMBOL_SLOT('R', 'a')] = 88, [SYMBOL_SLOT('A', 'c')] = 89, [SYMBOL_SLOT('T', 'h')] = 90,
+    [SYMBOL_SLOT('P', 'a')] = 91, [SYMBOL_SLOT('U', 0)] = 92, [SYMBOL_SLOT('N', 'p')] = 93,
+    [SYMBOL_SLOT('P', 'u')] = 94, [SYMBOL_SLOT('A', 'm')] = 95, [SYMBOL_SLOT('C', 'm')] = 96,
+    [SYMBOL_SLOT('B', 'k')] = 97, [SYMBOL_SLOT('C', 'f')] = 98, [SYMBOL_SLOT('E', 's')] = 99,
+    [SYMBOL_SLOT('F', 'm')] = 100, [SYMBOL_SLOT('M', 'd')] = 101, [SYMBOL_SLOT('N', 'o')] = 102,
+    [SYMBOL_SLOT('L', 'r')] = 103, [SYMBOL_SLOT('R', 'f')] = 104, [SYMBOL_SLOT('D', 'b')] = 105,
+    [SYMBOL_SLOT('S', 'g')] = 106, [SYMBOL_SLOT('B', 'h')] = 107, [SYMBOL_SLOT('H', 's')] = 108,
+    [SYMBOL_SLOT('M', 't')] = 109, [SYMBOL_SLOT('D', 's')] = 110, [SYMBOL_SLOT('R', 'g')] = 111,
+    [SYMBOL_SLOT('C', 'n')] = 112, [SYMBOL_SLOT('N', 'h')] = 113, [SYMBOL_SLOT('F', 'l')] = 114,
+    [SYMBOL_SLOT('M', 'c')] = 115, [SYMBOL_SLOT('L', 'v')] = 116, [SYMBOL_SLOT('T', 's')] = 117,
+    [SYMBOL_SLOT('O', 'g')] = 118,
+    [SYMBOL_SLOT('D', 0)] = 1, [SYMBOL_SLOT('T', 0)] = 1, // deuterium and tritium
+};
+
+const Element *element_get(int id)
+{
+    if (id < 0 || id >= ELEMENT_COUNT)
+        id = 0;
+    return &elements[id];
+}
+
+int element_id(const char *symbol)
+{
+    int first = toupper((unsigned char)symbol[0]);
+    if (first < 'A' || first > 'Z')
+        return 0;
+
+    int second = 0;
+    if (symbol[1])
+    {
+        second = tolower((unsigned char)symbol[1]);
+        if (second < 'a' || second > 'z' || symbol[2])
+            return 0;
+    }
+    return symbolIndex[SYMBOL_SLOT(first, second)];
+}
+
+const char *element_symbol(int id)
+{
+    return element_get(id)->symbol;
+}
+
+// ball radii of H, C, N and O from before the element table, 0 elsewhere
+static const float classicRadius[] = {[1] = 0.2f, [6] = 0.3f, [7] = 0.25f, [8] = 0.25f};
+
+void element_props(int element, vec3 color, float *radius)
+{
+    const Element *e = element_get(element);
+    color[0] = e->color[0] / 255.0f;
+    color[1] = e->color[1] / 255.0f;
+    color[2] = e->color[2] / 255.0f;
+
+    int classic = element > 0 && element < (int)(sizeof(classicRadius) / sizeof(classicRadius[0]));
+    *radius = classic && classicRadius[element] > 0.0f ? classicRadius[element] : e->vdw_radius * ELEMENT_BALL_SCALE;
+}
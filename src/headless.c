@@ -0,0 +1,190 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glad/glad.h>
+#include <headless.h>
+
+#ifndef _WIN32
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+// surfaceless Mesa needs neither a display server nor a GPU, other EGLs get their default display
+static EGLDisplay open_display(void)
+{
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    EGLDisplay display = EGL_NO_DISPLAY;
+    if (getPlatformDisplay)
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    if (display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    return display;
+}
+
+static int create_context(Headless *headless)
+{
+    EGLDisplay display = open_display();
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL))
+    {
+        printf("Failed to initialize EGL\n");
+        return -1;
+    }
+    headless->display = display;
+
+    // surfaceless displays only offer pbuffer configs, EGL defaults to window ones
+    const EGLint configAttribs[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount == 0 || !eglBindAPI(EGL_OPENGL_API))
+    {
+        printf("No EGL config for desktop OpenGL\n");
+        return -1;
+    }
+
+    // the same context version the window asks GLFW for
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE};
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (context == EGL_NO_CONTEXT)
+    {
+        printf("Failed to create an OpenGL 3.3 core EGL context\n");
+        return -1;
+    }
+    headless->context = context;
+
+    // no surface at all, everything goes to the framebuffer object
+    if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+    {
+        printf("Failed to make the EGL context current\n");
+        return -1;
+    }
+
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress))
+    {
+        printf("Failed to initialize GLAD\n");
+        return -1;
+    }
+    return 0;
+}
+#endif
+
+int headless_create(Headless *headless, int width, int height)
+{
+    memset(headless, 0, sizeof(Headless));
+#ifdef _WIN32
+    printf("Headless rendering needs EGL, it is only available on Linux\n");
+    return -1;
+#else
+    if (width <= 0 || height <= 0)
+    {
+        printf("Invalid headless resolution %dx%d\n", width, height);
+        return -1;
+    }
+    if (create_context(headless) != 0)
+    {
+        headless_delete(headless);
+        return -1;
+    }
+
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxSize);
+    if (width > maxSize || height > maxSize)
+    {
+        printf("Headless resolution %dx%d exceeds the renderbuffer limit of %d\n", width, height, maxSize);
+        headless_delete(headless);
+        return -1;
+    }
+
+    glGenRenderbuffers(1, &headless->colorRBO);
+    glBindRenderbuffer(GL_RENDERBUFFER, headless->colorRBO);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glGenRenderbuffers(1, &headless->depthRBO);
+    glBindRenderbuffer(GL_RENDERBUFFER, headless->depthRBO);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &headless->FBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, headless->FBO);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, headless->colorRBO);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, headless->depthRBO);
+    headless->width = width;
+    headless->height = height;
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        printf("Headless framebuffer is incomplete\n");
+        headless_delete(headless);
+        return -1;
+    }
+
+    glViewport(0, 0, width, height);
+    printf("Headless %dx%d on %s\n", width, height, glGetString(GL_RENDERER));
+    return 0;
+#endif
+}
+
+int headless_writeImage(const Headless *headless, const char *path)
+{
+    int width = headless->width, height = headless->height;
+    size_t rowSize = (size_t)width * 3;
+    unsigned char *pixels = malloc(rowSize * height);
+    if (!pixels)
+    {
+        printf("Memory allocation error for headless image\n");
+        return -1;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, headless->FBO);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+
+    FILE *file = fopen(path, "wb");
+    if (!file)
+    {
+        printf("Could not open %s for writing\n", path);
+        free(pixels);
+        return -1;
+    }
+
+    // GL rows start at the bottom
+    int failed = fprintf(file, "P6\n%d %d\n255\n", width, height) < 0;
+    for (int y = height - 1; y >= 0 && !failed; y--)
+    {
+        failed = fwrite(pixels + y * rowSize, 1, rowSize, file) != rowSize;
+    }
+    failed |= fclose(file) != 0;
+    free(pixels);
+
+    if (failed)
+    {
+        printf("Error writing %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+void headless_delete(Headless *headless)
+{
+#ifndef _WIN32
+    if (headless->context)
+    {
+        if (headless->FBO)
+            glDeleteFramebuffers(1, &headless->FBO);
+        if (headless->colorRBO)
+            glDeleteRenderbuffers(1, &headless->colorRBO);
+        if (headless->depthRBO)
+            glDeleteRenderbuffers(1, &headless->depthRBO);
+
+        eglMakeCurrent(headless->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(headless->display, headless->context);
+    }
+    if (headless->display)
+        eglTerminate(headless->display);
+#endif
+    memset(headless, 0, sizeof(Headless));
+}
@@ -0,0 +1,272 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <hiz.h>
+
+// nearest-filtered single-level texture, sampled only with texelFetch
+static unsigned int level_texture(GLenum internalFormat, GLenum format, int width, int height)
+{
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return texture;
+}
+
+static int level_framebuffer(unsigned int *fbo, GLenum attachment, unsigned int texture)
+{
+    glGenFramebuffers(1, fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, *fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, texture, 0);
+    if (attachment == GL_DEPTH_ATTACHMENT)
+    {
+        glDrawBuffer(GL_NONE); // depth only
+        glReadBuffer(GL_NONE);
+    }
+    return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE ? 0 : -1;
+}
+
+int hiz_resize(HiZ *hiz, int viewport_width, int viewport_height)
+{
+    if (viewport_width <= 0 || viewport_height <= 0)
+        return -1;
+    if (hiz->depthFBO && viewport_width == hiz->viewport_width && viewport_height == hiz->viewport_height)
+        return 0;
+
+    hiz_delete(hiz);
+    hiz->viewport_width = viewport_width;
+    hiz->viewport_height = viewport_height;
+
+    GLint previous;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
+
+    hiz->depthTexture = level_texture(GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, viewport_width, viewport_height);
+    int failed = level_framebuffer(&hiz->depthFBO, GL_DEPTH_ATTACHMENT, hiz->depthTexture);
+
+    // GPU levels halve (rounding up) until one fits HIZ_WIDTH
+    int w = viewport_width, h = viewport_height;
+    while (w > HIZ_WIDTH && hiz->reduce_count < HIZ_MAX_LEVELS && !failed)
+    {
+        w = (w + 1) / 2;
+        h = (h + 1) / 2;
+        int l = hiz->reduce_count++;
+        hiz->reduceTexture[l] = level_texture(GL_R32F, GL_RED, w, h);
+        failed = level_framebuffer(&hiz->reduceFBO[l], GL_COLOR_ATTACHMENT0, hiz->reduceTexture[l]);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, previous);
+    hiz->width = w;
+    hiz->height = h;
+    hiz->shift = hiz->reduce_count;
+
+    glGenVertexArrays(1, &hiz->reduceVAO);
+    glGenBuffers(1, &hiz->PBO);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, hiz->PBO);
+    glBufferData(GL_PIXEL_PACK_BUFFER, (size_t)w * h * sizeof(float), NULL, GL_STREAM_READ);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    // CPU levels continue halving down to 1x1
+    size_t texels = 0;
+    for (int l = 0; l < HIZ_MAX_LEVELS; l++)
+    {
+        hiz->level_width[l] = w;
+        hiz->level_height[l] = h;
+        hiz->level_count++;
+        texels += (size_t)w * h;
+        if (w == 1 && h == 1)
+            break;
+        w = (w + 1) / 2;
+        h = (h + 1) / 2;
+    }
+
+    float *pyramid = failed ? NULL : malloc(texels * sizeof(float));
+    if (!pyramid)
+    {
+        printf(failed ? "Depth pyramid framebuffer is incomplete\n" : "Memory allocation error for depth pyramid\n");
+        hiz_delete(hiz);
+        return -1;
+    }
+    for (int l = 0; l < hiz->level_count; l++)
+    {
+        hiz->levels[l] = pyramid;
+        pyramid += (size_t)hiz->level_width[l] * hiz->level_height[l];
+    }
+    return 0;
+}
+
+void hiz_update(HiZ *hiz)
+{
+    if (!hiz->pending)
+        return;
+    hiz->pending = 0;
+
+    // a frame later the copy is done, mapping does not wait for the GPU
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, hiz->PBO);
+    const float *depth = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (size_t)hiz->width * hiz->height * sizeof(float), GL_MAP_READ_BIT);
+    if (depth)
+        memcpy(hiz->levels[0], depth, (size_t)hiz->width * hiz->height * sizeof(float));
+    int mapped = depth && glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (!mapped)
+    {
+        hiz->valid = 0;
+        return;
+    }
+
+    // farthest of each 2x2 block, an odd last row / column folds into its neighbor
+    for (int l = 1; l < hiz->level_count; l++)
+    {
+        const float *src = hiz->levels[l - 1];
+        int sw = hiz->level_width[l - 1], sh = hiz->level_height[l - 1];
+        float *dst = hiz->levels[l];
+        int dw = hiz->level_width[l], dh = hiz->level_height[l];
+
+        for (int y = 0; y < dh; y++)
+        {
+            int y0 = 2 * y, y1 = 2 * y + 1 < sh ? 2 * y + 1 : 2 * y;
+            for (int x = 0; x < dw; x++)
+            {
+                int x0 = 2 * x, x1 = 2 * x + 1 < sw ? 2 * x + 1 : 2 * x;
+                float d = fmaxf(fmaxf(src[y0 * sw + x0], src[y0 * sw + x1]), fmaxf(src[y1 * sw + x0], src[y1 * sw + x1]));
+                dst[y * dw + x] = d;
+            }
+        }
+    }
+    glm_mat4_copy(hiz->pending_mvp, hiz->mvp);
+    hiz->valid = 1;
+}
+
+void hiz_begin(HiZ *hiz, mat4 mvp)
+{
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &hiz->previousFBO);
+    glGetIntegerv(GL_VIEWPORT, hiz->previousViewport);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, hiz->depthFBO);
+    glViewport(0, 0, hiz->viewport_width, hiz->viewport_height);
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    glm_mat4_copy(mvp, hiz->pending_mvp);
+}
+
+void hiz_end(HiZ *hiz, const Shader *reduce)
+{
+    // each level from the one before, the depth texture first
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    glDisable(GL_DEPTH_TEST);
+    shader_use(reduce);
+    glBindVertexArray(hiz->reduceVAO);
+    glActiveTexture(GL_TEXTURE0);
+
+    unsigned int src = hiz->depthTexture;
+    int w = hiz->viewport_width, h = hiz->viewport_height;
+    for (int l = 0; l < hiz->reduce_count; l++)
+    {
+        w = (w + 1) / 2;
+        h = (h + 1) / 2;
+        glBindFramebuffer(GL_FRAMEBUFFER, hiz->reduceFBO[l]);
+        glViewport(0, 0, w, h);
+        glBindTexture(GL_TEXTURE_2D, src);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        src = hiz->reduceTexture[l];
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindVertexArray(0);
+    if (depthTest)
+        glEnable(GL_DEPTH_TEST);
+
+    // into the pixel buffer, glReadPixels returns without waiting for the GPU
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, hiz->PBO);
+    if (hiz->reduce_count > 0)
+    {
+        glReadPixels(0, 0, hiz->width, hiz->height, GL_RED, GL_FLOAT, 0);
+    }
+    else
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, hiz->depthFBO);
+        glReadPixels(0, 0, hiz->width, hiz->height, GL_DEPTH_COMPONENT, GL_FLOAT, 0);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    hiz->pending = 1;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, hiz->previousFBO);
+    glViewport(hiz->previousViewport[0], hiz->previousViewport[1], hiz->previousViewport[2], hiz->previousViewport[3]);
+}
+
+// level 0 texel of a [0, 1] window coordinate along an axis of `size` viewport pixels
+static int window_texel(float s, int size, int shift)
+{
+    int pixel = (int)(glm_clamp(s, 0.0f, 1.0f) * size);
+    return (pixel < size ? pixel : size - 1) >> shift;
+}
+
+int hiz_occluded(const HiZ *hiz, const vec3 min, const vec3 max)
+{
+    if (!hiz->valid)
+        return 0;
+
+    // screen rectangle and nearest window depth of the box corners
+    float x0 = 1.0f, y0 = 1.0f, x1 = 0.0f, y1 = 0.0f, nearest = 1.0f;
+    for (int c = 0; c < 8; c++)
+    {
+        vec4 corner = {c & 1 ? max[0] : min[0], c & 2 ? max[1] : min[1], c & 4 ? max[2] : min[2], 1.0f};
+        vec4 clip;
+        glm_mat4_mulv((vec4 *)hiz->mvp, corner, clip);
+        if (clip[3] <= 0.0f)
+            return 0; // reaches behind the eye
+
+        float sx = clip[0] / clip[3] * 0.5f + 0.5f;
+        float sy = clip[1] / clip[3] * 0.5f + 0.5f;
+        float sz = clip[2] / clip[3] * 0.5f + 0.5f;
+        x0 = fminf(x0, sx);
+        y0 = fminf(y0, sy);
+        x1 = fmaxf(x1, sx);
+        y1 = fmaxf(y1, sy);
+        nearest = fminf(nearest, sz);
+    }
+    if (nearest <= 0.0f)
+        return 0; // crosses the near plane
+
+    // texels of a level cover whole blocks of viewport pixels, so the rectangle's texels
+    // hold the farthest depth of every pixel it touches
+    int px0 = window_texel(x0, hiz->viewport_width, hiz->shift), py0 = window_texel(y0, hiz->viewport_height, hiz->shift);
+    int px1 = window_texel(x1, hiz->viewport_width, hiz->shift), py1 = window_texel(y1, hiz->viewport_height, hiz->shift);
+
+    // coarsest level where the rectangle still covers at most 2x2 texels
+    int level = 0;
+    while (level + 1 < hiz->level_count && ((px1 >> level) - (px0 >> level) > 1 || (py1 >> level) - (py0 >> level) > 1))
+        level++;
+
+    const float *depth = hiz->levels[level];
+    int lw = hiz->level_width[level];
+    for (int y = py0 >> level; y <= py1 >> level; y++)
+    {
+        for (int x = px0 >> level; x <= px1 >> level; x++)
+        {
+            if (depth[y * lw + x] >= nearest)
+                return 0;
+        }
+    }
+    return 1;
+}
+
+void hiz_delete(HiZ *hiz)
+{
+    if (hiz->depthFBO)
+        glDeleteFramebuffers(1, &hiz->depthFBO);
+    if (hiz->depthTexture)
+        glDeleteTextures(1, &hiz->depthTexture);
+    for (int l = 0; l < hiz->reduce_count; l++)
+    {
+        glDeleteFramebuffers(1, &hiz->reduceFBO[l]);
+        glDeleteTextures(1, &hiz->reduceTexture[l]);
+    }
+    if (hiz->reduceVAO)
+        glDeleteVertexArrays(1, &hiz->reduceVAO);
+    if (hiz->PBO)
+        glDeleteBuffers(1, &hiz->PBO);
+    free(hiz->level_count ? hiz->levels[0] : NULL);
+    memset(hiz, 0, sizeof(HiZ));
+}
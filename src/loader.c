@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <loader.h>
+#include <mode.h>
+
+struct Loader
+{
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+
+    char request[INPUT_BUFFER_SIZE];
+    int hasRequest;
+    int working;
+    int quit;
+
+    Molecule *result; // latest finished molecule, not yet picked up
+};
+
+static void discard(Molecule *mol)
+{
+    if (mol)
+    {
+        molecule_delete(mol);
+        free(mol);
+    }
+}
+
+static void *loader_run(void *arg)
+{
+    Loader *loader = arg;
+    char molecule_str[INPUT_BUFFER_SIZE];
+
+    pthread_mutex_lock(&loader->lock);
+    for (;;)
+    {
+        while (!loader->hasRequest && !loader->quit)
+            pthread_cond_wait(&loader->wake, &loader->lock);
+        if (loader->quit)
+            break;
+
+        strcpy(molecule_str, loader->request);
+        loader->hasRequest = 0;
+        loader->working = 1;
+        pthread_mutex_unlock(&loader->lock);
+
+        Molecule *mol = generate_molecule_data(molecule_str);
+        if (!mol)
+        {
+            printf("Failed to generate molecule: %s\n", molecule_str);
+        }
+
+        pthread_mutex_lock(&loader->lock);
+        loader->working = 0;
+        if (loader->hasRequest || loader->quit)
+        {
+            // superseded while generating
+            discard(mol);
+        }
+        else if (mol)
+        {
+            discard(loader->result);
+            loader->result = mol;
+        }
+    }
+    pthread_mutex_unlock(&loader->lock);
+    return NULL;
+}
+
+Loader *loader_create(void)
+{
+    Loader *loader = calloc(1, sizeof(Loader));
+    if (!loader)
+    {
+        printf("Memory allocation error\n");
+        return NULL;
+    }
+
+    pthread_mutex_init(&loader->lock, NULL);
+    pthread_cond_init(&loader->wake, NULL);
+
+    if (pthread_create(&loader->thread, NULL, loader_run, loader) != 0)
+    {
+        printf("Failed to start loader thread\n");
+        pthread_cond_destroy(&loader->wake);
+        pthread_mutex_destroy(&loader->lock);
+        free(loader);
+        return NULL;
+    }
+    return loader;
+}
+
+void loader_request(Loader *loader, const char *molecule_str)
+{
+    pthread_mutex_lock(&loader->lock);
+    strncpy(loader->request, molecule_str, sizeof(loader->request) - 1);
+    loader->request[sizeof(loader->request) - 1] = '\0';
+    loader->hasRequest = 1;
+    pthread_cond_signal(&loader->wake);
+    pthread_mutex_unlock(&loader->lock);
+}
+
+Molecule *loader_poll(Loader *loader)
+{
+    pthread_mutex_lock(&loader->lock);
+    Molecule *mol = loader->result;
+    loader->result = NULL;
+    pthread_mutex_unlock(&loader->lock);
+    return mol;
+}
+
+int loader_busy(Loader *loader)
+{
+    pthread_mutex_lock(&loader->lock);
+    int busy = loader->hasRequest || loader->working;
+    pthread_mutex_unlock(&loader->lock);
+    return busy;
+}
+
+void loader_delete(Loader *loader)
+{
+    if (!loader)
+        return;
+
+    pthread_mutex_lock(&loader->lock);
+    loader->quit = 1;
+    pthread_cond_signal(&loader->wake);
+    pthread_mutex_unlock(&loader->lock);
+
+    // waits for a running obabel to finish
+    pthread_join(loader->thread, NULL);
+
+    discard(loader->result);
+    pthread_cond_destroy(&loader->wake);
+    pthread_mutex_destroy(&loader->lock);
+    free(loader);
+}
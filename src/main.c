@@ -9,15 +9,30 @@
 #include <sphere.h>
 #include <cylinder.h>
 #include <molecule.h>
+#include <parse.h>
+#include <loader.h>
+#include <cache.h>
+#include <mode.h>
+#include <headless.h>
+#include <time.h>
 
 const float WIDTH = 800.0f;
 const float HEIGHT = 600.0f;
 
+#define CONFORMER_CACHE_DIR "data/cache"
+#define CONFORMER_CACHE_MAX_BYTES (64L * 1024 * 1024)
+
 Camera camera;
 
 float deltaTime = 0.0f; // Time between current frame and last frame
 float lastFrame = 0.0f; // Time of last frame
 
+AtomStyle atomStyle = ATOM_STYLE_MESH;
+BondStyle bondStyle = BOND_STYLE_MESH;
+int occlusionCulling = 1;
+int gpuCulling = 0;
+int depthSort = 0;
+
 void framebuffer_size_callback(GLFWwindow *window, int width, int height)
 {
     glViewport(0, 0, width, height);
@@ -33,9 +48,10 @@ void scroll_callback(GLFWwindow *window, double xoffset, double yoffset)
 
 void processInput(GLFWwindow *window)
 {
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+    // typed keys belong to the input line, escape is handled by key_callback
+    if (currentMode == MODE_INSERT)
     {
-        glfwSetWindowShouldClose(window, GL_TRUE);
+        return;
     }
 
     if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
@@ -54,6 +70,56 @@ void processInput(GLFWwindow *window)
     {
         camera_processKeyboard(&camera, CAM_RIGHT, deltaTime);
     }
+
+    // atom style
+    if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
+    {
+        atomStyle = ATOM_STYLE_MESH;
+    }
+    if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
+    {
+        atomStyle = ATOM_STYLE_IMPOSTOR;
+    }
+
+    // bond style
+    if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS)
+    {
+        bondStyle = BOND_STYLE_MESH;
+    }
+    if (glfwGetKey(window, GLFW_KEY_4) == GLFW_PRESS)
+    {
+        bondStyle = BOND_STYLE_IMPOSTOR;
+    }
+
+    // occlusion culling
+    if (glfwGetKey(window, GLFW_KEY_5) == GLFW_PRESS)
+    {
+        occlusionCulling = 1;
+    }
+    if (glfwGetKey(window, GLFW_KEY_6) == GLFW_PRESS)
+    {
+        occlusionCulling = 0;
+    }
+
+    // GPU culling
+    if (glfwGetKey(window, GLFW_KEY_7) == GLFW_PRESS)
+    {
+        gpuCulling = 1;
+    }
+    if (glfwGetKey(window, GLFW_KEY_8) == GLFW_PRESS)
+    {
+        gpuCulling = 0;
+    }
+
+    // front-to-back atoms
+    if (glfwGetKey(window, GLFW_KEY_9) == GLFW_PRESS)
+    {
+        depthSort = 1;
+    }
+    if (glfwGetKey(window, GLFW_KEY_0) == GLFW_PRESS)
+    {
+        depthSort = 0;
+    }
 };
 
 static void ErrLog(GLuint program, GLenum pname, int success, char *infoLog)
@@ -66,11 +132,231 @@ static void ErrLog(GLuint program, GLenum pname, int success, char *infoLog)
     }
 };
 
+// writes a binary molecule file from a molfile, parser JSON, xyz file or SMILES string, no window is opened
+static int convert_molecule(const char *input, const char *output)
+{
+    Molecule *mol = NULL;
+    const char *ext = strrchr(input, '.');
+    if (ext && (strcmp(ext, ".mol") == 0 || strcmp(ext, ".sdf") == 0 || strcmp(ext, ".json") == 0))
+    {
+        mol = calloc(1, sizeof(Molecule));
+        if (!mol)
+        {
+            printf("Memory allocation error\n");
+            return 1;
+        }
+        strncpy(mol->name, input, sizeof(mol->name) - 1);
+
+        if (strcmp(ext, ".json") == 0)
+        {
+            load_molecule_from_JSON(input, mol);
+        }
+        else
+        {
+            load_molecule_from_molfile(input, mol);
+        }
+
+        if (!mol->structure.block)
+        {
+            molecule_delete(mol);
+            free(mol);
+            return 1;
+        }
+    }
+    else
+    {
+        mol = generate_molecule_data(input);
+        if (!mol)
+        {
+            return 1;
+        }
+    }
+
+    int result = save_molecule_binary(output, mol);
+    if (result == 0)
+    {
+        printf("Wrote %s: %d atoms, %d bonds\n", output, mol->structure.atom_count, mol->structure.bond_count);
+    }
+    molecule_delete(mol);
+    free(mol);
+    return result == 0 ? 0 : 1;
+}
+
+// the programs molecule_draw needs, shared by the window and headless rendering
+static MoleculeShaders create_molecule_shaders(void)
+{
+    Shader *sh = shader_create("static/vertex_shader.glsl", "static/fragment_shader.glsl");
+    if (!sh)
+    {
+        printf("Error on creating shader from file\n");
+    }
+
+    Shader *atom_sh = shader_create("static/atom_vs.glsl", "static/fragment_shader.glsl");
+    if (!atom_sh)
+    {
+        printf("Error on creating atom shader from file\n");
+    }
+
+    Shader *atom_impostor_sh = shader_create("static/atom_impostor_vs.glsl", "static/atom_impostor_fs.glsl");
+    if (!atom_impostor_sh)
+    {
+        printf("Error on creating atom impostor shader from file\n");
+    }
+
+    Shader *bond_impostor_sh = shader_create("static/bond_impostor_vs.glsl", "static/bond_impostor_fs.glsl");
+    if (!bond_impostor_sh)
+    {
+        printf("Error on creating bond impostor shader from file\n");
+    }
+
+    // GPU atom culling, the CPU hierarchy stays in use without it
+    const char *cullVaryings[] = {"oCenterRadius", "oColor"};
+    Shader *atom_cull_sh = shader_createFeedback("static/atom_cull_vs.glsl", "static/atom_cull_gs.glsl", cullVaryings, 2);
+    if (!atom_cull_sh)
+    {
+        printf("Error on creating atom culling shader from file, atoms are culled on the CPU\n");
+    }
+
+    Shader *hiz_reduce_sh = shader_create("static/hiz_reduce_vs.glsl", "static/hiz_reduce_fs.glsl");
+    if (!hiz_reduce_sh)
+    {
+        printf("Error on creating depth pyramid shader from file\n");
+    }
+
+    MoleculeShaders shaders = {atom_sh, atom_impostor_sh, sh, bond_impostor_sh, atom_cull_sh, hiz_reduce_sh};
+    return shaders;
+};
+
+static void delete_molecule_shaders(MoleculeShaders *shaders)
+{
+    shader_delete(shaders->bond_impostor);
+    shader_delete(shaders->atom_impostor);
+    shader_delete(shaders->atom);
+    shader_delete(shaders->atom_cull);
+    shader_delete(shaders->hiz_reduce);
+    shader_delete(shaders->bond);
+};
+
+// one frame of the scene into the bound framebuffer, `time` in seconds drives the rotation;
+// the window and headless rendering both go through here so their images match
+static void render_frame(Molecule *mol, MoleculeShaders *shaders, unsigned int frameUBO, Cube *light, int fbWidth, int fbHeight, float time)
+{
+    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // a minimized window has no framebuffer to take the aspect from
+    float aspect = fbWidth > 0 && fbHeight > 0 ? (float)fbWidth / fbHeight : WIDTH / HEIGHT;
+
+    // per-frame uniforms, shared by every program through the Frame block
+    FrameUniforms frame;
+    camera_getViewMatrix(&camera, frame.view);
+    glm_perspective(glm_rad(camera.zoom), aspect, 0.1f, 100.0f, frame.projection);
+    glm_ortho(0.0f, (float)fbWidth, 0.0f, (float)fbHeight, -1.0f, 1.0f, frame.screen);
+    glm_vec4(light->position, 1.0f, frame.lightPos);
+    glm_vec4(light->color, 1.0f, frame.lightColor);
+    shader_frameUpdate(frameUBO, &frame);
+
+    if (mol)
+    {
+        molecule_setViewport(mol, fbWidth, fbHeight);
+        molecule_setAtomStyle(mol, atomStyle);
+        molecule_setBondStyle(mol, bondStyle);
+        molecule_setOcclusion(mol, occlusionCulling);
+        molecule_setGpuCulling(mol, gpuCulling);
+        molecule_setDepthSort(mol, depthSort);
+        molecule_setOverdrawStats(mol, depthSort); // the title shows the overdraw it saves
+
+        // rotate mol
+        molecule_setAngle(mol, 10 * time);
+        molecule_draw(mol, shaders, frame.view, frame.projection);
+    }
+};
+
+static double seconds_now(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// renders `frames` frames (60 per second of rotation) of a molecule offscreen and writes the
+// last one as a PPM image; no window or display is needed, the time per frame is printed
+static int render_headless(const char *mol_str, int width, int height, const char *output, int frames)
+{
+    Headless headless;
+    if (headless_create(&headless, width, height) != 0)
+    {
+        return 1;
+    }
+    glEnable(GL_DEPTH_TEST);
+
+    MoleculeShaders mol_shaders = create_molecule_shaders();
+    unsigned int frameUBO = shader_frameCreate();
+    camera_create_position(&camera, (vec3){0.0f, 0.0f, 10.0f});
+
+    Cube light;
+    cube_init(&light, (vec3){0.0f, 0.0f, -10.0f}, (vec3){1.0f, 1.0f, 1.0f}, 1.0f);
+
+    int result = 1;
+    Molecule *mol = generate_molecule_data(mol_str);
+    if (mol && molecule_upload(mol) == 0)
+    {
+        double start = seconds_now();
+        for (int f = 0; f < frames; f++)
+        {
+            render_frame(mol, &mol_shaders, frameUBO, &light, width, height, f / 60.0f);
+        }
+        glFinish();
+        double elapsed = seconds_now() - start;
+
+        printf("%s: %d frame(s) at %dx%d, %.3f ms per frame, %ld triangles, %d draw calls, %d/%d atoms visible\n",
+               mol->name, frames, width, height, elapsed * 1000.0 / frames, mol->stats.triangles,
+               mol->stats.draw_calls, mol->stats.atoms_visible, mol->structure.atom_count);
+
+        if (headless_writeImage(&headless, output) == 0)
+        {
+            printf("Wrote %s\n", output);
+            result = 0;
+        }
+    }
+    if (mol)
+    {
+        molecule_delete(mol);
+        free(mol);
+    }
+
+    cube_delete(&light);
+    shader_frameDelete(frameUBO);
+    delete_molecule_shaders(&mol_shaders);
+    headless_delete(&headless);
+    return result;
+}
+
 int main(int argc, char *argv[])
 {
+    if (argc == 4 && strcmp(argv[1], "--convert") == 0)
+    {
+        return convert_molecule(argv[2], argv[3]);
+    }
+
+    if ((argc == 6 || argc == 7) && strcmp(argv[1], "--headless") == 0)
+    {
+        int frames = argc == 7 ? atoi(argv[6]) : 1;
+        if (frames < 1)
+        {
+            printf("Error: Frame count must be positive.\n");
+            return 1;
+        }
+        return render_headless(argv[5], atoi(argv[2]), atoi(argv[3]), argv[4], frames);
+    }
+
     if (argc != 2)
     {
         printf("Usage: %s -\"<molecule_string>\"\n", argv[0]);
+        printf("       %s -<file.molb>\n", argv[0]);
+        printf("       %s -<file.xyz>\n", argv[0]);
+        printf("       %s --convert <file.mol|file.sdf|file.json|file.xyz|molecule_string> <file.molb>\n", argv[0]);
+        printf("       %s --headless <width> <height> <image.ppm> <molecule_string|file.molb|file.xyz> [frames]\n", argv[0]);
         return 1;
     }
 
@@ -109,6 +395,8 @@ int main(int argc, char *argv[])
 
     glfwMakeContextCurrent(window);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetKeyCallback(window, key_callback);
+    glfwSetCharCallback(window, char_callback);
     // glfwSetCursorPosCallback(window, mouse_callback);
     // glfwSetScrollCallback(window, scroll_callback);
 
@@ -124,11 +412,7 @@ int main(int argc, char *argv[])
     glEnable(GL_DEPTH_TEST); // Enable depth testing
 
     // Shaders
-    Shader *sh = shader_create("static/vertex_shader.glsl", "static/fragment_shader.glsl");
-    if (!sh)
-    {
-        printf("Error on creating shader from file\n");
-    }
+    MoleculeShaders mol_shaders = create_molecule_shaders();
 
     Shader *light_sh = shader_create("static/light_vs.glsl", "static/light_fs.glsl");
     if (!light_sh)
@@ -143,14 +427,26 @@ int main(int argc, char *argv[])
         printf("Error on creating text shader from file\n");
     }
 
+    unsigned int frameUBO = shader_frameCreate();
+
     // load font
     loadFont("fonts/arial.ttf");
 
     // camera init
     camera_create_position(&camera, (vec3){0.0f, 0.0f, 10.0f});
 
-    // gen molecule
-    Molecule *mol = generate_molecule(mol_str);
+    // conformers generated before are reused, obabel only runs for new molecules
+    ConformerCache *conformerCache = cache_create(CONFORMER_CACHE_DIR, CONFORMER_CACHE_MAX_BYTES);
+    molecule_setConformerCache(conformerCache);
+
+    // gen molecule in the background, new ones are typed in insert mode
+    Loader *loader = loader_create();
+    if (!loader)
+    {
+        return -1;
+    }
+    loader_request(loader, mol_str);
+    Molecule *mol = NULL;
 
     // cube
     Cube *light = (Cube *)malloc(sizeof(Cube));
@@ -162,6 +458,8 @@ int main(int argc, char *argv[])
     // You can unbind the VAO afterwards so other VAO calls won't accidentally modify this VAO, but this rarely happens. Modifying other VAOs requires a call to glBindVertexArray anyways so we generally don't unbind VAOs (nor VBOs) when it's not directly necessary.
     glBindVertexArray(0);
 
+    float lastStats = 0.0f; // Time the window title last showed frame stats
+
     while (!glfwWindowShouldClose(window))
     {
         float currentFrame = glfwGetTime();
@@ -170,23 +468,77 @@ int main(int argc, char *argv[])
 
         processInput(window);
 
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        mat4 view;
-        camera_getViewMatrix(&camera, view);
-
-        mat4 projection;
-        glm_perspective(glm_rad(camera.zoom), WIDTH / HEIGHT, 0.1f, 100.0f, projection);
-
-        // cube_draw(light, light_sh, view, projection);
-
-        shader_setVec3(sh, "lightPos", light->position);
-        shader_setVec3(sh, "lightColor", light->color);
-
-        // rotate mol
-        molecule_setAngle(mol, 10 * glfwGetTime());
-        molecule_draw(mol, sh, view, projection);
+        char submitted[INPUT_BUFFER_SIZE];
+        if (mode_pollSubmitted(submitted, sizeof(submitted)))
+        {
+            printf("Molecule string: %s\n", submitted);
+            loader_request(loader, submitted);
+        }
+
+        // swap in a finished molecule, the previous one stays on screen until then
+        Molecule *next = loader_poll(loader);
+        if (next)
+        {
+            molecule_printMemory(next, "loaded");
+            if (molecule_upload(next) != 0)
+            {
+                // keep showing the previous molecule
+                molecule_delete(next);
+                free(next);
+                next = NULL;
+            }
+        }
+        if (next)
+        {
+            molecule_printMemory(next, "uploaded");
+            if (mol)
+            {
+                molecule_delete(mol);
+                free(mol);
+            }
+            mol = next;
+        }
+
+        int fbWidth, fbHeight;
+        glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
+        render_frame(mol, &mol_shaders, frameUBO, light, fbWidth, fbHeight, glfwGetTime());
+
+        // cube_draw(light, light_sh);
+
+        // no text rendering yet, the title doubles as status line
+        if (currentMode == MODE_INSERT)
+        {
+            char title[INPUT_BUFFER_SIZE + 32];
+            snprintf(title, sizeof(title), "MolecGL - insert: %s_", inputBuffer);
+            glfwSetWindowTitle(window, title);
+            lastStats = 0.0f;
+        }
+        // a minimized window has an empty framebuffer, nothing was drawn to report
+        else if (fbWidth > 0 && fbHeight > 0 && currentFrame - lastStats >= 1.0f)
+        {
+            char title[256];
+            if (!mol)
+            {
+                snprintf(title, sizeof(title), "MolecGL - generating...");
+            }
+            else
+            {
+                char overdraw[64] = "";
+                // the viewport is empty while minimized and until a swapped in molecule is drawn
+                if (depthSort && mol->viewport[0] > 0 && mol->viewport[1] > 0)
+                {
+                    snprintf(overdraw, sizeof(overdraw), ", %.2f atom fragments/pixel",
+                             (double)mol->stats.atom_fragments / ((long)mol->viewport[0] * mol->viewport[1]));
+                }
+                snprintf(title, sizeof(title), "MolecGL - %s%s - %ld triangles, %d draw calls, %d/%d atoms visible, %d/%d clusters occluded%s",
+                         mol->name, loader_busy(loader) ? " (generating...)" : "",
+                         mol->stats.triangles, mol->stats.draw_calls,
+                         mol->stats.atoms_visible, mol->structure.atom_count,
+                         mol->stats.clusters_culled, mol->stats.clusters_tested, overdraw);
+            }
+            glfwSetWindowTitle(window, title);
+            lastStats = currentFrame;
+        }
 
         glfwPollEvents();
         glfwSwapBuffers(window);
@@ -195,12 +547,24 @@ int main(int argc, char *argv[])
     cube_delete(light);
     free(light);
 
-    molecule_delete(mol);
-    free(mol);
+    loader_delete(loader);
+    if (mol)
+    {
+        molecule_delete(mol);
+        free(mol);
+    }
+
+    if (conformerCache)
+    {
+        cache_printStats(conformerCache);
+        molecule_setConformerCache(NULL);
+        cache_delete(conformerCache);
+    }
 
+    shader_frameDelete(frameUBO);
     shader_delete(text_sh);
     shader_delete(light_sh);
-    shader_delete(sh);
+    delete_molecule_shaders(&mol_shaders);
 
     glfwTerminate();
     return 0;
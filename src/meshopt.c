@@ -0,0 +1,206 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <meshopt.h>
+
+float meshopt_acmr(const MeshIndex *indices, int index_count, int vertex_count, int cache_size)
+{
+    if (index_count < 3)
+        return 0.0f;
+
+    // FIFO cache: a vertex is cached while fewer than cache_size misses happened since its own
+    int *missTime = malloc(vertex_count * sizeof(int));
+    if (!missTime)
+        return 0.0f;
+    for (int v = 0; v < vertex_count; v++)
+    {
+        missTime[v] = -cache_size - 1;
+    }
+
+    int misses = 0;
+    for (int i = 0; i < index_count; i++)
+    {
+        int v = indices[i];
+        if (misses - missTime[v] > cache_size)
+        {
+            missTime[v] = misses++;
+        }
+    }
+
+    free(missTime);
+    return (float)misses / (index_count / 3);
+}
+
+// next fanning vertex: most recently cached candidate that stays in the cache while its
+// remaining triangles are emitted, otherwise a dead end
+static int tipsify_next(const int *candidates, int candidate_count, const int *live, const int *cacheTime,
+                        int time, int cache_size, int *deadEnds, int *deadEndCount, int *cursor, int vertex_count)
+{
+    int best = -1;
+    int bestPriority = -1;
+    for (int c = 0; c < candidate_count; c++)
+    {
+        int v = candidates[c];
+        if (live[v] <= 0)
+            continue;
+
+        int priority = 0;
+        if (time - cacheTime[v] + 2 * live[v] <= cache_size)
+            priority = time - cacheTime[v];
+        if (priority > bestPriority)
+        {
+            bestPriority = priority;
+            best = v;
+        }
+    }
+    if (best >= 0)
+        return best;
+
+    // dead end: recently emitted vertices first, then scan for any vertex with triangles left
+    while (*deadEndCount > 0)
+    {
+        int v = deadEnds[--*deadEndCount];
+        if (live[v] > 0)
+            return v;
+    }
+    while (*cursor < vertex_count)
+    {
+        int v = (*cursor)++;
+        if (live[v] > 0)
+            return v;
+    }
+    return -1;
+}
+
+int meshopt_optimizeCache(MeshIndex *indices, int index_count, int vertex_count, int cache_size)
+{
+    int triangle_count = index_count / 3;
+
+    // vertex -> triangles adjacency (CSR), live triangle counts, cache time stamps
+    int *offsets = calloc(vertex_count + 1, sizeof(int));
+    int *adjacency = malloc(index_count * sizeof(int));
+    int *live = calloc(vertex_count, sizeof(int));
+    int *cacheTime = calloc(vertex_count, sizeof(int));
+    int *deadEnds = malloc(index_count * sizeof(int));
+    int *candidates = malloc(index_count * sizeof(int));
+    unsigned char *emitted = calloc(triangle_count > 0 ? triangle_count : 1, 1);
+    MeshIndex *output = malloc(index_count * sizeof(MeshIndex));
+    if (!offsets || !adjacency || !live || !cacheTime || !deadEnds || !candidates || !emitted || !output)
+    {
+        free(offsets);
+        free(adjacency);
+        free(live);
+        free(cacheTime);
+        free(deadEnds);
+        free(candidates);
+        free(emitted);
+        free(output);
+        return -1;
+    }
+
+    for (int i = 0; i < triangle_count * 3; i++)
+    {
+        live[indices[i]]++;
+    }
+    for (int v = 0; v < vertex_count; v++)
+    {
+        offsets[v + 1] = offsets[v] + live[v];
+    }
+    int *fill = cacheTime; // reused as insertion cursor, reset below
+    memcpy(fill, offsets, vertex_count * sizeof(int));
+    for (int t = 0; t < triangle_count; t++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            int v = indices[3 * t + k];
+            adjacency[fill[v]++] = t;
+        }
+    }
+    memset(cacheTime, 0, vertex_count * sizeof(int));
+
+    int time = cache_size + 1;
+    int deadEndCount = 0;
+    int cursor = 1;
+    int written = 0;
+    int fan = triangle_count > 0 ? 0 : -1;
+    while (fan >= 0)
+    {
+        int candidate_count = 0;
+        for (int a = offsets[fan]; a < offsets[fan + 1]; a++)
+        {
+            int t = adjacency[a];
+            if (emitted[t])
+                continue;
+            emitted[t] = 1;
+
+            for (int k = 0; k < 3; k++)
+            {
+                int v = indices[3 * t + k];
+                output[written++] = (MeshIndex)v;
+                deadEnds[deadEndCount++] = v;
+                candidates[candidate_count++] = v;
+                live[v]--;
+                if (time - cacheTime[v] > cache_size)
+                {
+                    cacheTime[v] = time++;
+                }
+            }
+        }
+
+        fan = tipsify_next(candidates, candidate_count, live, cacheTime, time, cache_size,
+                           deadEnds, &deadEndCount, &cursor, vertex_count);
+    }
+
+    memcpy(indices, output, written * sizeof(MeshIndex));
+
+    free(offsets);
+    free(adjacency);
+    free(live);
+    free(cacheTime);
+    free(deadEnds);
+    free(candidates);
+    free(emitted);
+    free(output);
+    return 0;
+}
+
+int meshopt_optimizeFetch(void *vertices, size_t stride, int vertex_count, MeshIndex *indices, int index_count)
+{
+    int *remap = malloc(vertex_count * sizeof(int));
+    char *copy = malloc(vertex_count * stride);
+    if (!remap || !copy)
+    {
+        free(remap);
+        free(copy);
+        return -1;
+    }
+
+    for (int v = 0; v < vertex_count; v++)
+    {
+        remap[v] = -1;
+    }
+
+    int next = 0;
+    for (int i = 0; i < index_count; i++)
+    {
+        int v = indices[i];
+        if (remap[v] < 0)
+            remap[v] = next++;
+        indices[i] = (MeshIndex)remap[v];
+    }
+    for (int v = 0; v < vertex_count; v++)
+    {
+        if (remap[v] < 0)
+            remap[v] = next++;
+    }
+
+    memcpy(copy, vertices, vertex_count * stride);
+    for (int v = 0; v < vertex_count; v++)
+    {
+        memcpy((char *)vertices + remap[v] * stride, copy + v * stride, stride);
+    }
+
+    free(remap);
+    free(copy);
+    return 0;
+}
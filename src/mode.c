@@ -0,0 +1,95 @@
+#include <string.h>
+#include <mode.h>
+
+Mode currentMode = MODE_NORMAL;
+int cursorPosition = 0;
+char inputBuffer[INPUT_BUFFER_SIZE];
+
+static char submitted[INPUT_BUFFER_SIZE];
+static int hasSubmitted = 0;
+
+// the key press that enters insert mode is also delivered as a character
+static int skipNextChar = 0;
+
+void key_callback(GLFWwindow *window, int key, int scancode, int action, int mods)
+{
+    if (action != GLFW_PRESS && action != GLFW_REPEAT)
+        return;
+
+    if (currentMode == MODE_NORMAL)
+    {
+        if (key == GLFW_KEY_ESCAPE)
+        {
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
+        }
+        else if (key == GLFW_KEY_I && action == GLFW_PRESS)
+        {
+            currentMode = MODE_INSERT;
+            cursorPosition = 0;
+            inputBuffer[0] = '\0';
+            skipNextChar = 1;
+        }
+        return;
+    }
+
+    switch (key)
+    {
+    case GLFW_KEY_ESCAPE:
+        currentMode = MODE_NORMAL;
+        break;
+    case GLFW_KEY_ENTER:
+        if (cursorPosition > 0)
+        {
+            strcpy(submitted, inputBuffer);
+            hasSubmitted = 1;
+        }
+        currentMode = MODE_NORMAL;
+        break;
+    case GLFW_KEY_BACKSPACE:
+        if (cursorPosition > 0)
+        {
+            memmove(&inputBuffer[cursorPosition - 1], &inputBuffer[cursorPosition], strlen(inputBuffer) - cursorPosition + 1);
+            cursorPosition--;
+        }
+        break;
+    case GLFW_KEY_LEFT:
+        if (cursorPosition > 0)
+            cursorPosition--;
+        break;
+    case GLFW_KEY_RIGHT:
+        if (cursorPosition < (int)strlen(inputBuffer))
+            cursorPosition++;
+        break;
+    }
+}
+
+void char_callback(GLFWwindow *windows, unsigned int codepoint)
+{
+    if (currentMode != MODE_INSERT)
+        return;
+
+    if (skipNextChar)
+    {
+        skipNextChar = 0;
+        return;
+    }
+
+    // SMILES is plain ASCII
+    size_t len = strlen(inputBuffer);
+    if (codepoint < 32 || codepoint > 126 || len + 1 >= INPUT_BUFFER_SIZE)
+        return;
+
+    memmove(&inputBuffer[cursorPosition + 1], &inputBuffer[cursorPosition], len - cursorPosition + 1);
+    inputBuffer[cursorPosition++] = (char)codepoint;
+}
+
+int mode_pollSubmitted(char *out, size_t size)
+{
+    if (!hasSubmitted)
+        return 0;
+
+    strncpy(out, submitted, size - 1);
+    out[size - 1] = '\0';
+    hasSubmitted = 0;
+    return 1;
+}
@@ -0,0 +1,298 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include <molecule.h>
+#include <molbin.h>
+#include <element.h>
+
+// bond sections are copied straight into the structure's int arrays
+_Static_assert(sizeof(int) == sizeof(uint32_t), "bond indices must be 32-bit");
+
+// the format is little-endian and read in place, big-endian hosts are not supported
+static int host_is_little_endian(void)
+{
+    const uint16_t probe = 1;
+    return *(const uint8_t *)&probe == 1;
+}
+
+static uint64_t align_up(uint64_t offset)
+{
+    return (offset + MOLB_ALIGN - 1) & ~(uint64_t)(MOLB_ALIGN - 1);
+}
+
+// section [offset, offset + bytes) lies inside the file and is aligned for its element type
+static int section_valid(const MolbFile *file, uint64_t offset, uint64_t bytes)
+{
+    return offset % 4 == 0 && offset <= file->size && bytes <= file->size - offset;
+}
+
+static const void *section(const MolbFile *file, uint64_t offset)
+{
+    return (const char *)file->base + offset;
+}
+
+static int map_file(MolbFile *file, const char *filename)
+{
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE)
+        return -1;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(handle);
+        return -1;
+    }
+
+    HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(handle); // the mapping keeps the file open
+    if (!mapping)
+        return -1;
+
+    void *base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!base)
+    {
+        CloseHandle(mapping);
+        return -1;
+    }
+
+    file->mapping = mapping;
+    file->base = base;
+    file->size = (size_t)size.QuadPart;
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps the file open
+    if (base == MAP_FAILED)
+        return -1;
+
+    file->base = base;
+    file->size = (size_t)st.st_size;
+#endif
+    return 0;
+}
+
+void molb_close(MolbFile *file)
+{
+    if (!file->base)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(file->base);
+    CloseHandle(file->mapping);
+#else
+    munmap(file->base, file->size);
+#endif
+    memset(file, 0, sizeof(MolbFile));
+}
+
+int molb_open(MolbFile *file, const char *filename)
+{
+    memset(file, 0, sizeof(MolbFile));
+    if (!host_is_little_endian())
+    {
+        printf("Binary molecule files need a little-endian host\n");
+        return -1;
+    }
+
+    if (map_file(file, filename) != 0)
+    {
+        printf("Unable to map molecule file: %s\n", filename);
+        return -1;
+    }
+
+    const MolbHeader *header = file->base;
+    if (file->size < sizeof(MolbHeader) || memcmp(header->magic, MOLB_MAGIC, 4) != 0)
+    {
+        printf("Not a binary molecule file: %s\n", filename);
+        molb_close(file);
+        return -1;
+    }
+    if (header->version != MOLB_VERSION || header->header_size < sizeof(MolbHeader))
+    {
+        printf("Unsupported binary molecule version %u: %s\n", header->version, filename);
+        molb_close(file);
+        return -1;
+    }
+
+    uint64_t atoms = header->atom_count;
+    uint64_t bonds = header->bond_count;
+    if (header->file_size != file->size ||
+        !section_valid(file, header->x_offset, atoms * sizeof(float)) ||
+        !section_valid(file, header->y_offset, atoms * sizeof(float)) ||
+        !section_valid(file, header->z_offset, atoms * sizeof(float)) ||
+        !section_valid(file, header->elements_offset, atoms * sizeof(uint8_t)) ||
+        !section_valid(file, header->bond_a_offset, bonds * sizeof(uint32_t)) ||
+        !section_valid(file, header->bond_b_offset, bonds * sizeof(uint32_t)) ||
+        !section_valid(file, header->bond_order_offset, bonds * sizeof(uint8_t)))
+    {
+        printf("Corrupt binary molecule file: %s\n", filename);
+        molb_close(file);
+        return -1;
+    }
+
+    file->header = header;
+    file->x = section(file, header->x_offset);
+    file->y = section(file, header->y_offset);
+    file->z = section(file, header->z_offset);
+    file->elements = section(file, header->elements_offset);
+    file->bond_a = section(file, header->bond_a_offset);
+    file->bond_b = section(file, header->bond_b_offset);
+    file->bond_order = section(file, header->bond_order_offset);
+    return 0;
+}
+
+int load_molecule_from_binary(const char *filename, Molecule *mol)
+{
+    MolbFile file;
+    if (molb_open(&file, filename) != 0)
+        return -1;
+
+    int atom_count = (int)file.header->atom_count;
+    int bond_count = (int)file.header->bond_count;
+
+    Structure *s = &mol->structure;
+    if (structure_init(s, &mol->arena, atom_count, bond_count) != 0)
+    {
+        molb_close(&file);
+        return -1;
+    }
+
+    // the sections are laid out like the structure's arrays
+    size_t atoms = (size_t)atom_count;
+    size_t bonds = (size_t)bond_count;
+    memcpy(s->x, file.x, atoms * sizeof(float));
+    memcpy(s->y, file.y, atoms * sizeof(float));
+    memcpy(s->z, file.z, atoms * sizeof(float));
+    memcpy(s->element, file.elements, atoms);
+    memcpy(s->bond_a, file.bond_a, bonds * sizeof(uint32_t));
+    memcpy(s->bond_b, file.bond_b, bonds * sizeof(uint32_t));
+    memcpy(s->bond_order, file.bond_order, bonds);
+    molb_close(&file);
+
+    // render properties once per element present, a palette entry each
+    unsigned char colorIndex[256];
+    float radius[256];
+    int seen[256] = {0};
+    for (int i = 0; i < atom_count; i++)
+    {
+        int e = s->element[i];
+        if (!seen[e])
+        {
+            element_props(e, s->palette[s->palette_count], &radius[e]);
+            colorIndex[e] = (unsigned char)s->palette_count++;
+            seen[e] = 1;
+        }
+        s->color[i] = colorIndex[e];
+        s->radius[i] = radius[e];
+    }
+
+    for (int i = 0; i < bond_count; i++)
+    {
+        if ((unsigned)s->bond_a[i] >= (unsigned)atom_count || (unsigned)s->bond_b[i] >= (unsigned)atom_count)
+        {
+            printf("Bond atom index out of range: %s\n", filename);
+            structure_delete(s);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// zero padding up to the next section
+static int write_padding(FILE *fp, uint64_t *offset)
+{
+    static const char zeros[MOLB_ALIGN] = {0};
+    uint64_t aligned = align_up(*offset);
+    size_t pad = (size_t)(aligned - *offset);
+    *offset = aligned;
+    return pad == 0 || fwrite(zeros, 1, pad, fp) == pad ? 0 : -1;
+}
+
+// one aligned section, advances offset past it
+static int write_section(FILE *fp, uint64_t *offset, const void *data, size_t bytes)
+{
+    if (write_padding(fp, offset) != 0 || (bytes > 0 && fwrite(data, 1, bytes, fp) != bytes))
+        return -1;
+    *offset += bytes;
+    return 0;
+}
+
+int save_molecule_binary(const char *filename, const Molecule *mol)
+{
+    if (!host_is_little_endian())
+    {
+        printf("Binary molecule files need a little-endian host\n");
+        return -1;
+    }
+
+    const Structure *s = &mol->structure;
+    uint64_t atoms = (uint64_t)s->atom_count;
+    uint64_t bonds = (uint64_t)s->bond_count;
+
+    MolbHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MOLB_MAGIC, 4);
+    header.version = MOLB_VERSION;
+    header.header_size = sizeof(MolbHeader);
+    header.atom_count = (uint32_t)atoms;
+    header.bond_count = (uint32_t)bonds;
+    snprintf(header.name, sizeof(header.name), "%s", mol->name);
+
+    header.x_offset = align_up(sizeof(MolbHeader));
+    header.y_offset = align_up(header.x_offset + atoms * sizeof(float));
+    header.z_offset = align_up(header.y_offset + atoms * sizeof(float));
+    header.elements_offset = align_up(header.z_offset + atoms * sizeof(float));
+    header.bond_a_offset = align_up(header.elements_offset + atoms * sizeof(uint8_t));
+    header.bond_b_offset = align_up(header.bond_a_offset + bonds * sizeof(uint32_t));
+    header.bond_order_offset = align_up(header.bond_b_offset + bonds * sizeof(uint32_t));
+    header.file_size = header.bond_order_offset + bonds * sizeof(uint8_t);
+
+    FILE *fp = fopen(filename, "wb");
+    if (!fp)
+    {
+        printf("Unable to write molecule file: %s\n", filename);
+        return -1;
+    }
+
+    int ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+    uint64_t offset = sizeof(header);
+
+    // the structure's arrays as they are, bond indices are never negative
+    ok = ok && write_section(fp, &offset, s->x, atoms * sizeof(float)) == 0;
+    ok = ok && write_section(fp, &offset, s->y, atoms * sizeof(float)) == 0;
+    ok = ok && write_section(fp, &offset, s->z, atoms * sizeof(float)) == 0;
+    ok = ok && write_section(fp, &offset, s->element, atoms * sizeof(uint8_t)) == 0;
+    ok = ok && write_section(fp, &offset, s->bond_a, bonds * sizeof(uint32_t)) == 0;
+    ok = ok && write_section(fp, &offset, s->bond_b, bonds * sizeof(uint32_t)) == 0;
+    ok = ok && write_section(fp, &offset, s->bond_order, bonds * sizeof(uint8_t)) == 0;
+
+    if (fclose(fp) != 0)
+        ok = 0;
+    if (!ok)
+    {
+        printf("Failed to write molecule file: %s\n", filename);
+        remove(filename);
+        return -1;
+    }
+    return 0;
+}
@@ -1,134 +1,842 @@
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
+#include <float.h>
 #include <molecule.h>
-#include <cjson/cJSON.h>
+#include <parse.h>
+#include <cache.h>
+#include <molbin.h>
 
-#define JSON_FILE_NAME "data/molecule.json"
+// obabel writes the molfile to stdout when no -O is given
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#define SHELL_QUOTE '"'
+#define OBABEL_CMD "obabel \"-:%s\" --gen3D -omol"
+#else
+#define SHELL_QUOTE '\''
+#define OBABEL_CMD "obabel '-:%s' --gen3D -omol"
+#endif
 
-Molecule *generate_molecule(const char *molecule_str)
+// tessellation of each level of detail, finest first
+static const int sphereLodStacks[MOL_LOD_COUNT] = {STACK_COUNT, 12, 8, 5};
+static const int sphereLodSectors[MOL_LOD_COUNT] = {SECTOR_COUNT, 24, 16, 10};
+static const int cylinderLodSectors[MOL_LOD_COUNT] = {CY_SECTOR_COUNT, 18, 10, 6};
+
+// smallest projected radius (pixels) that still selects each level
+static const float lodMinPixels[MOL_LOD_COUNT] = {48.0f, 16.0f, 6.0f, 0.0f};
+
+// unit meshes shared by every molecule's instanced atom and bond draws
+static Sphere unitSpheres[MOL_LOD_COUNT];
+static Cylinder unitCylinders[MOL_LOD_COUNT];
+static int meshUsers = 0;
+
+// generated conformers are looked up here before running Open Babel, NULL disables caching
+static ConformerCache *conformerCache = NULL;
+
+void molecule_setConformerCache(ConformerCache *cache)
+{
+    conformerCache = cache;
+};
+
+Molecule *generate_molecule_data(const char *molecule_str)
 {
     // printf("Generating Molecule from %s\n", molecule_str);
-    Molecule *mol = malloc(sizeof(Molecule));
+    Molecule *mol = calloc(1, sizeof(Molecule));
     if (!mol)
     {
         printf("Memory allocation error\n");
         return NULL;
     }
+    arena_init(&mol->arena, ARENA_CHUNK_SIZE);
 
     // copy name
     strncpy(mol->name, molecule_str, sizeof(mol->name));
     mol->name[sizeof(mol->name) - 1] = '\0';
 
-    // run subprocess obabel to generate molecule.mol
-    char obabel_cmd[256];
-    snprintf(obabel_cmd, sizeof(obabel_cmd), "obabel -:%s --gen3D -omol -O data/molecule.mol", molecule_str);
-    if (system(obabel_cmd) != 0)
+    molecule_setScale(mol, 1.0f);
+
+    // pre-converted binary files are mapped directly, no Open Babel involved
+    size_t len = strlen(molecule_str);
+    size_t extLen = strlen(MOLB_EXT);
+    if (len > extLen && strcmp(molecule_str + len - extLen, MOLB_EXT) == 0)
     {
-        printf("Failed to generate molecule.mol with Open Babel\n");
-        free(mol);
-        return NULL;
+        if (load_molecule_from_binary(molecule_str, mol) != 0)
+        {
+            molecule_delete(mol);
+            free(mol);
+            return NULL;
+        }
+        return mol;
     }
 
-    // run go parser/main.go to generate molecule.json
-    if (system("go run parser/main.go molecule.mol molecule.json") != 0)
+    // so are coordinate-only xyz files, their bonds are perceived from distances
+    if (len > 4 && strcmp(molecule_str + len - 4, ".xyz") == 0)
     {
-        printf("Failed to generate molecule.json with Go parser\n");
+        if (load_molecule_from_xyz(molecule_str, mol) != 0)
+        {
+            molecule_delete(mol);
+            free(mol);
+            return NULL;
+        }
+        return mol;
+    }
+
+    // the string is quoted for the shell, SMILES never contains quotes
+    if (strchr(molecule_str, SHELL_QUOTE) != NULL)
+    {
+        printf("Invalid molecule string: %s\n", molecule_str);
+        molecule_delete(mol);
         free(mol);
         return NULL;
     }
 
-    load_molecule_from_JSON(JSON_FILE_NAME, mol);
+    if (conformerCache && cache_lookup(conformerCache, molecule_str, OBABEL_CMD, mol) == 0)
+    {
+        return mol;
+    }
 
-    // printf("finished loading mol from JSON\n");
+    // run subprocess obabel and read the molfile from its stdout, nothing touches the disk
+    char obabel_cmd[512];
+    snprintf(obabel_cmd, sizeof(obabel_cmd), OBABEL_CMD, molecule_str);
+    FILE *pipe = popen(obabel_cmd, "r");
+    if (!pipe)
+    {
+        printf("Failed to start Open Babel\n");
+        molecule_delete(mol);
+        free(mol);
+        return NULL;
+    }
 
-    if (mol->atoms == NULL || mol->bonds == NULL)
+    int parsed = load_molecule_from_stream(pipe, mol);
+    if (pclose(pipe) != 0 || parsed < 0)
     {
-        printf("failed to create molecule struct\n");
+        printf("Failed to generate molecule with Open Babel\n");
+        molecule_delete(mol);
+        free(mol);
         return NULL;
     }
 
+    if (conformerCache)
+    {
+        cache_store(conformerCache, molecule_str, OBABEL_CMD, mol);
+    }
+
     // printf("finished gen molecule\n");
     return mol;
 };
 
-void molecule_init(Molecule *mol, const char *name, int atom_count, Atom *atoms, int bond_count, Bond *bonds)
+Molecule *generate_molecule(const char *molecule_str)
+{
+    Molecule *mol = generate_molecule_data(molecule_str);
+    if (mol && molecule_upload(mol) != 0)
+    {
+        molecule_delete(mol);
+        free(mol);
+        return NULL;
+    }
+    return mol;
+};
+
+int molecule_init(Molecule *mol, const char *name, Structure *structure)
 {
     strncpy(mol->name, name, sizeof(mol->name) - 1);
     mol->name[sizeof(mol->name) - 1] = '\0';
 
-    mol->atom_count = atom_count;
-    mol->bond_count = bond_count;
+    mol->structure = *structure;
+    memset(structure, 0, sizeof(Structure));
+
+    mol->angle = 0.0f;
+    glm_vec3_zero(mol->position);
+    molecule_setScale(mol, 1.0f);
+
+    return molecule_upload(mol);
+}
+
+// per-atom attributes from the bound GL_ARRAY_BUFFER, starting at instance `first`, into the current VAO
+static void bind_atom_instances(size_t first)
+{
+    size_t base = first * sizeof(AtomInstance);
+
+    // center(x, y, z) + radius
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(AtomInstance), (void *)(base + offsetof(AtomInstance, center)));
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
+
+    // color(r, g, b, a)
+    glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(AtomInstance), (void *)(base + offsetof(AtomInstance, color)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+}
+
+// instances and bounding spheres of every atom from the structure
+static void fill_atoms(Molecule *mol)
+{
+    for (int i = 0; i < mol->structure.atom_count; ++i)
+    {
+        AtomInstance *inst = &mol->atom_instances[i];
+        atom_getInstance(&mol->structure, i, inst);
+        glm_vec4(inst->center, inst->radius, mol->atom_bounds[i]);
+    }
+}
+
+static int upload_atoms(Molecule *mol)
+{
+    int count = mol->structure.atom_count;
+    mol->atom_instances = arena_alloc(&mol->arena, count * sizeof(AtomInstance));
+    mol->atom_bounds = arena_alloc(&mol->arena, count * sizeof(vec4));
+    mol->atom_visible = arena_alloc(&mol->arena, count * sizeof(int));
+    mol->atom_frame = arena_alloc(&mol->arena, count * sizeof(AtomInstance));
+    mol->atom_lod = arena_alloc(&mol->arena, count);
+    if (!mol->atom_instances || !mol->atom_bounds || !mol->atom_visible || !mol->atom_frame || !mol->atom_lod)
+    {
+        printf("Memory allocation error for atom instances\n");
+        return -1;
+    }
+    fill_atoms(mol);
+    if (bvh_build(&mol->atom_bvh, &mol->arena, mol->atom_bounds, count) != 0)
+        return -1;
+    if (depthsort_init(&mol->atom_sort, &mol->arena, count) != 0)
+        return -1;
+
+    // every style draws this frame's visible instances
+    glGenBuffers(1, &mol->atomFrameVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, mol->atomFrameVBO);
+    glBufferData(GL_ARRAY_BUFFER, count * sizeof(AtomInstance), NULL, GL_STREAM_DRAW);
 
-    mol->atoms = (Atom *)malloc(atom_count * sizeof(Atom));
-    for (int i = 0; i < atom_count; ++i)
+    glGenVertexArrays(1, &mol->atomImpostorVAO);
+    glBindVertexArray(mol->atomImpostorVAO);
+    bind_atom_instances(0);
+
+    glGenVertexArrays(MOL_LOD_COUNT, mol->atomLodVAO);
+    for (int l = 0; l < MOL_LOD_COUNT; ++l)
     {
-        mol->atoms[i] = atoms[i];
+        glBindVertexArray(mol->atomLodVAO[l]);
+        sphere_bind(&unitSpheres[l]);
+        glBindBuffer(GL_ARRAY_BUFFER, mol->atomFrameVBO);
+        bind_atom_instances(0);
     }
 
-    mol->bonds = (Bond *)malloc(bond_count * sizeof(Bond));
-    for (int i = 0; i < bond_count; ++i)
+    // GPU culling reads every atom as a point, the color passes through as one integer
+    glGenBuffers(1, &mol->atomInstanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, mol->atomInstanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, count * sizeof(AtomInstance), mol->atom_instances, GL_STATIC_DRAW);
+
+    glGenVertexArrays(1, &mol->atomCullVAO);
+    glBindVertexArray(mol->atomCullVAO);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(AtomInstance), (void *)offsetof(AtomInstance, center));
+    glEnableVertexAttribArray(3);
+    glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, sizeof(AtomInstance), (void *)offsetof(AtomInstance, color));
+    glEnableVertexAttribArray(1);
+
+    glGenQueries(MOL_LOD_COUNT, mol->atomCullQueries);
+    glGenQueries(2, mol->overdrawQueries);
+    mol->overdraw_frame = 0;
+    mol->overdraw_begun[0] = mol->overdraw_begun[1] = 0;
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return 0;
+}
+
+// per-line attributes from the bound GL_ARRAY_BUFFER, starting at instance `first`, into the current VAO
+static void bind_bond_instances(size_t first)
+{
+    size_t base = first * sizeof(BondInstance);
+
+    // transform, one vec4 column per attribute location
+    for (int c = 0; c < 4; ++c)
     {
-        mol->bonds[i] = bonds[i];
+        glVertexAttribPointer(3 + c, 4, GL_FLOAT, GL_FALSE, sizeof(BondInstance), (void *)(base + offsetof(BondInstance, transform) + c * sizeof(vec4)));
+        glEnableVertexAttribArray(3 + c);
+        glVertexAttribDivisor(3 + c, 1);
     }
+
+    // color(r, g, b, a)
+    glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(BondInstance), (void *)(base + offsetof(BondInstance, color)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
 }
 
-void molecule_setAngle(Molecule *mol, float angle)
+// instances and bounding spheres of every bond line from the structure
+static void fill_bonds(Molecule *mol)
 {
-    for (int i = 0; i < mol->bond_count; ++i)
+    mol->bond_instance_count = 0;
+    for (int i = 0; i < mol->structure.bond_count; ++i)
     {
-        if (mol->bonds)
+        vec3 color;
+        float radius;
+        BondType type = bond_order_props(mol->structure.bond_order[i], color, &radius);
+        mol->bond_instance_count += bond_getInstances(&mol->structure, i, type, color, radius, &mol->bond_instances[mol->bond_instance_count]);
+    }
+
+    // unit cylinder: radius 1 around z, height 1, so the farthest point is a rim corner
+    for (int i = 0; i < mol->bond_instance_count; ++i)
+    {
+        vec4 *t = mol->bond_instances[i].transform;
+        float reach = sqrtf(glm_vec3_norm2(t[0]) + 0.25f * glm_vec3_norm2(t[2]));
+        glm_vec4(t[3], reach, mol->bond_bounds[i]);
+    }
+}
+
+static int upload_bonds(Molecule *mol)
+{
+    int capacity = mol->structure.bond_count * BOND_MAX_INSTANCES;
+    mol->bond_instances = arena_alloc(&mol->arena, capacity * sizeof(BondInstance));
+    mol->bond_bounds = arena_alloc(&mol->arena, capacity * sizeof(vec4));
+    mol->bond_visible = arena_alloc(&mol->arena, capacity * sizeof(int));
+    mol->bond_frame = arena_alloc(&mol->arena, capacity * sizeof(BondInstance));
+    mol->bond_lod = arena_alloc(&mol->arena, capacity);
+    if (!mol->bond_instances || !mol->bond_bounds || !mol->bond_visible || !mol->bond_frame || !mol->bond_lod)
+    {
+        printf("Memory allocation error for bond instances\n");
+        return -1;
+    }
+    fill_bonds(mol);
+    if (bvh_build(&mol->bond_bvh, &mol->arena, mol->bond_bounds, mol->bond_instance_count) != 0)
+        return -1;
+
+    // every style draws this frame's visible instances
+    glGenBuffers(1, &mol->bondFrameVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, mol->bondFrameVBO);
+    glBufferData(GL_ARRAY_BUFFER, mol->bond_instance_count * sizeof(BondInstance), NULL, GL_STREAM_DRAW);
+
+    glGenVertexArrays(1, &mol->bondImpostorVAO);
+    glBindVertexArray(mol->bondImpostorVAO);
+    bind_bond_instances(0);
+
+    glGenVertexArrays(MOL_LOD_COUNT, mol->bondLodVAO);
+    for (int l = 0; l < MOL_LOD_COUNT; ++l)
+    {
+        glBindVertexArray(mol->bondLodVAO[l]);
+        cylinder_bind(&unitCylinders[l]);
+        glBindBuffer(GL_ARRAY_BUFFER, mol->bondFrameVBO);
+        bind_bond_instances(0);
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return 0;
+}
+
+// GL objects and the shared mesh reference, also whatever a failed upload got to create
+static void release_gpu(Molecule *mol)
+{
+    glDeleteVertexArrays(MOL_LOD_COUNT, mol->atomLodVAO);
+    glDeleteVertexArrays(1, &mol->atomImpostorVAO);
+    glDeleteBuffers(1, &mol->atomFrameVBO);
+    glDeleteVertexArrays(1, &mol->atomCullVAO);
+    glDeleteBuffers(1, &mol->atomInstanceVBO);
+    glDeleteQueries(MOL_LOD_COUNT, mol->atomCullQueries);
+    glDeleteQueries(2, mol->overdrawQueries);
+
+    glDeleteVertexArrays(MOL_LOD_COUNT, mol->bondLodVAO);
+    glDeleteVertexArrays(1, &mol->bondImpostorVAO);
+    glDeleteBuffers(1, &mol->bondFrameVBO);
+
+    hiz_delete(&mol->hiz);
+
+    mol->uploaded = 0;
+    if (--meshUsers == 0)
+    {
+        for (int l = 0; l < MOL_LOD_COUNT; ++l)
         {
-            bond_setAngle(&mol->bonds[i], angle);
+            sphere_delete(&unitSpheres[l]);
+            cylinder_delete(&unitCylinders[l]);
         }
     }
+}
 
-    for (int i = 0; i < mol->atom_count; ++i)
+int molecule_upload(Molecule *mol)
+{
+    if (meshUsers++ == 0)
     {
-        if (mol->atoms)
+        for (int l = 0; l < MOL_LOD_COUNT; ++l)
         {
-            atom_setAngle(&mol->atoms[i], angle);
+            sphere_init(&unitSpheres[l], sphereLodStacks[l], sphereLodSectors[l]);
+            cylinder_init(&unitCylinders[l], cylinderLodSectors[l]);
         }
     }
+    mol->uploaded = 1;
+
+    if (upload_atoms(mol) != 0 || upload_bonds(mol) != 0)
+    {
+        printf("Failed to upload molecule %s\n", mol->name);
+        release_gpu(mol);
+        return -1;
+    }
+    return 0;
+}
+
+void molecule_refit(Molecule *mol)
+{
+    if (!mol->atom_instances || !mol->bond_instances)
+        return;
+
+    // same atoms and bond orders, so the instance counts and tree shapes still hold
+    fill_atoms(mol);
+    fill_bonds(mol);
+    bvh_refit(&mol->atom_bvh, mol->atom_bounds);
+    bvh_refit(&mol->bond_bvh, mol->bond_bounds);
+    mol->atom_sort.valid = 0;
+
+    glBindBuffer(GL_ARRAY_BUFFER, mol->atomInstanceVBO);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, mol->structure.atom_count * sizeof(AtomInstance), mol->atom_instances);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// instances are static in molecule space, moving the molecule only rebuilds this matrix
+static void update_model(Molecule *mol)
+{
+    glm_translate_make(mol->model, mol->position);
+    glm_rotate_y(mol->model, glm_rad(mol->angle), mol->model);
+    glm_scale_uni(mol->model, mol->scale);
+
+    // model is rigid plus uniform scale, so its normal matrix is the rotation alone
+    glm_mat4_pick3(mol->model, mol->normal);
+    glm_mat3_scale(mol->normal, 1.0f / mol->scale);
+}
+
+void molecule_setAngle(Molecule *mol, float angle)
+{
+    mol->angle = angle;
+    update_model(mol);
+};
+
+void molecule_setPosition(Molecule *mol, vec3 position)
+{
+    glm_vec3_copy(position, mol->position);
+    update_model(mol);
+};
+
+void molecule_setScale(Molecule *mol, float scale)
+{
+    mol->scale = scale;
+    update_model(mol);
+};
+
+void molecule_setAtomStyle(Molecule *mol, AtomStyle style)
+{
+    mol->atom_style = style;
+};
+
+void molecule_setBondStyle(Molecule *mol, BondStyle style)
+{
+    mol->bond_style = style;
+};
+
+void molecule_setViewport(Molecule *mol, int width, int height)
+{
+    mol->viewport[0] = width;
+    mol->viewport[1] = height;
+};
+
+void molecule_setOcclusion(Molecule *mol, int enabled)
+{
+    if (!enabled)
+        hiz_delete(&mol->hiz); // stale once re-enabled
+    mol->occlusion = enabled;
+};
+
+void molecule_setGpuCulling(Molecule *mol, int enabled)
+{
+    mol->gpu_culling = enabled;
+};
+
+void molecule_setDepthSort(Molecule *mol, int enabled)
+{
+    mol->depth_sort = enabled;
 };
 
-void molecule_draw(Molecule *mol, Shader *sh, mat4 view, mat4 projection)
+void molecule_setOverdrawStats(Molecule *mol, int enabled)
 {
-    for (int i = 0; i < mol->bond_count; ++i)
+    mol->overdraw_stats = enabled;
+};
+
+// level of detail from the projected radius of a sphere at `center` (molecule space)
+static int lod_select(mat4 modelView, float pixelScale, vec3 center, float radius)
+{
+    float depth = -(modelView[0][2] * center[0] + modelView[1][2] * center[1] + modelView[2][2] * center[2] + modelView[3][2]);
+    if (depth <= radius)
+        return 0;
+
+    float pixels = radius * pixelScale / depth;
+    for (int l = 0; l < MOL_LOD_COUNT - 1; ++l)
     {
-        if (mol->bonds)
-        {
-            bond_draw(&mol->bonds[i], sh, view, projection);
-        }
+        if (pixels >= lodMinPixels[l])
+            return l;
+    }
+    return MOL_LOD_COUNT - 1;
+}
+
+// stable counting sort of the `count` instances src[index[k]] of `stride` bytes into per-level ranges of dst
+static void lod_bucket(const void *src, const int *index, void *dst, size_t stride, const unsigned char *lod, int count, int first[MOL_LOD_COUNT + 1])
+{
+    int counts[MOL_LOD_COUNT] = {0};
+    for (int i = 0; i < count; ++i)
+    {
+        counts[lod[i]]++;
     }
 
-    for (int i = 0; i < mol->atom_count; ++i)
+    first[0] = 0;
+    for (int l = 0; l < MOL_LOD_COUNT; ++l)
     {
-        if (mol->atoms)
-        {
-            atom_draw(&mol->atoms[i], sh, view, projection);
-        }
+        first[l + 1] = first[l] + counts[l];
+    }
+
+    int next[MOL_LOD_COUNT];
+    memcpy(next, first, sizeof(next));
+    for (int i = 0; i < count; ++i)
+    {
+        memcpy((char *)dst + next[lod[i]]++ * stride, (const char *)src + index[i] * stride, stride);
     }
 }
 
-void molecule_delete(Molecule *mol)
+// copies the instances src[index[k]] to dst
+static void gather(const void *src, const int *index, void *dst, size_t stride, int count)
 {
-    if (mol->atoms)
+    for (int k = 0; k < count; ++k)
     {
-        for (int i = 0; i < mol->atom_count; ++i)
-        {
-            atom_delete(&mol->atoms[i]);
-        }
-        free(mol->atoms);
-        mol->atoms = NULL;
+        memcpy((char *)dst + k * stride, (const char *)src + index[k] * stride, stride);
     }
+}
 
-    if (mol->bonds)
+// replaces the contents of a per-frame instance buffer of `capacity` bytes
+static void stream_frame(unsigned int vbo, const void *data, size_t bytes, size_t capacity)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, capacity, NULL, GL_STREAM_DRAW); // orphan
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, data);
+}
+
+// this frame's visible atoms into atomFrameVBO, grouped by level of detail
+static void bucket_atoms(Molecule *mol, mat4 modelView, float pixelScale, int first[MOL_LOD_COUNT + 1])
+{
+    int count = mol->stats.atoms_visible;
+    for (int k = 0; k < count; ++k)
     {
-        for (int i = 0; i < mol->bond_count; ++i)
-        {
-            bond_delete(&mol->bonds[i]);
-        }
-        free(mol->bonds);
-        mol->bonds = NULL;
+        AtomInstance *inst = &mol->atom_instances[mol->atom_visible[k]];
+        mol->atom_lod[k] = lod_select(modelView, pixelScale, inst->center, inst->radius);
+    }
+
+    lod_bucket(mol->atom_instances, mol->atom_visible, mol->atom_frame, sizeof(AtomInstance), mol->atom_lod, count, first);
+    stream_frame(mol->atomFrameVBO, mol->atom_frame, count * sizeof(AtomInstance), mol->structure.atom_count * sizeof(AtomInstance));
+}
+
+// Frustum, size and level of detail of every atom on the GPU. Transform feedback appends the
+// kept instances to atomFrameVBO, one range per level (a single one for impostors), and a
+// query per range gives its size. Returns the visible count, first[] as from lod_bucket.
+static int cull_atoms_gpu(Molecule *mol, const Shader *cull, mat4 modelView, vec4 planes[6], float pixelScale, int levels, int first[MOL_LOD_COUNT + 1])
+{
+    shader_use(cull);
+    shader_setUniformVec4Array(cull, SHADER_UNIFORM_PLANES, planes, 6);
+    shader_setUniformMat4(cull, SHADER_UNIFORM_MODEL_VIEW, modelView);
+    shader_setUniformFloat(cull, SHADER_UNIFORM_PIXEL_SCALE, pixelScale);
+
+    glBindBuffer(GL_ARRAY_BUFFER, mol->atomFrameVBO);
+    glBufferData(GL_ARRAY_BUFFER, mol->structure.atom_count * sizeof(AtomInstance), NULL, GL_STREAM_DRAW); // orphan
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBindVertexArray(mol->atomCullVAO);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, mol->atomFrameVBO);
+    glBeginTransformFeedback(GL_POINTS);
+    for (int l = 0; l < levels; ++l)
+    {
+        // draws inside one transform feedback append to each other, level by level
+        float upper = l == 0 ? FLT_MAX : lodMinPixels[l - 1];
+        float lower = levels == 1 ? 0.0f : lodMinPixels[l];
+        vec2 range = {fmaxf(lower, MOL_CULL_MIN_PIXELS), upper};
+        shader_setUniformVec2(cull, SHADER_UNIFORM_PIXEL_RANGE, range);
+
+        glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, mol->atomCullQueries[l]);
+        glDrawArrays(GL_POINTS, 0, mol->structure.atom_count);
+        glEndQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN);
+    }
+    glEndTransformFeedback();
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    glBindVertexArray(0);
+    glDisable(GL_RASTERIZER_DISCARD);
+
+    // GL 3.3 cannot source an instance count from a buffer, so the draws wait for the pass
+    first[0] = 0;
+    for (int l = 0; l < MOL_LOD_COUNT; ++l)
+    {
+        GLuint written = 0;
+        if (l < levels)
+            glGetQueryObjectuiv(mol->atomCullQueries[l], GL_QUERY_RESULT, &written);
+        first[l + 1] = first[l] + (int)written;
+    }
+    return first[MOL_LOD_COUNT];
+}
+
+static void draw_atom_meshes(Molecule *mol, const int first[MOL_LOD_COUNT + 1])
+{
+    glBindBuffer(GL_ARRAY_BUFFER, mol->atomFrameVBO); // read by bind_atom_instances
+    for (int l = 0; l < MOL_LOD_COUNT; ++l)
+    {
+        int count = first[l + 1] - first[l];
+        mol->stats.atom_lod_counts[l] = count;
+        if (count == 0)
+            continue;
+
+        glBindVertexArray(mol->atomLodVAO[l]);
+        bind_atom_instances(first[l]);
+        glDrawElementsInstanced(GL_TRIANGLES, unitSpheres[l].index_count, MESH_INDEX_TYPE, 0, count);
+
+        mol->stats.draw_calls++;
+        mol->stats.triangles += (long)count * (unitSpheres[l].index_count / 3);
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+static void draw_bond_meshes(Molecule *mol, mat4 modelView, float pixelScale)
+{
+    int count = mol->stats.bonds_visible;
+    for (int k = 0; k < count; ++k)
+    {
+        BondInstance *inst = &mol->bond_instances[mol->bond_visible[k]];
+        float radius = glm_vec3_norm(inst->transform[0]);
+        mol->bond_lod[k] = lod_select(modelView, pixelScale, inst->transform[3], radius);
+    }
+
+    int first[MOL_LOD_COUNT + 1];
+    lod_bucket(mol->bond_instances, mol->bond_visible, mol->bond_frame, sizeof(BondInstance), mol->bond_lod, count, first);
+    stream_frame(mol->bondFrameVBO, mol->bond_frame, count * sizeof(BondInstance), mol->bond_instance_count * sizeof(BondInstance));
+
+    for (int l = 0; l < MOL_LOD_COUNT; ++l)
+    {
+        int count = first[l + 1] - first[l];
+        mol->stats.bond_lod_counts[l] = count;
+        if (count == 0)
+            continue;
+
+        glBindVertexArray(mol->bondLodVAO[l]);
+        bind_bond_instances(first[l]);
+        glDrawElementsInstanced(GL_TRIANGLES, unitCylinders[l].index_count, MESH_INDEX_TYPE, 0, count);
+
+        mol->stats.draw_calls++;
+        mol->stats.triangles += (long)count * (unitCylinders[l].index_count / 3);
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+typedef struct
+{
+    const HiZ *hiz;
+    FrameStats *stats;
+} OcclusionTest;
+
+static int occlusion_test(const BvhNode *leaf, void *user)
+{
+    OcclusionTest *occlusion = user;
+    occlusion->stats->clusters_tested++;
+    if (hiz_occluded(occlusion->hiz, leaf->min, leaf->max))
+    {
+        occlusion->stats->clusters_culled++;
+        return 0;
+    }
+    occlusion->stats->clusters_drawn++;
+    return 1;
+}
+
+// this frame's visible atoms, depth only at viewport resolution, into next frame's depth pyramid.
+// The coarsest sphere lies inside the true one and every pixel is reduced into the texels
+// covering it, so the pyramid never holds a depth nearer than the real scene.
+static void render_occluders(Molecule *mol, MoleculeShaders *shaders, mat4 mvp)
+{
+    int count = mol->stats.atoms_visible;
+    gather(mol->atom_instances, mol->atom_visible, mol->atom_frame, sizeof(AtomInstance), count);
+    stream_frame(mol->atomFrameVBO, mol->atom_frame, count * sizeof(AtomInstance), mol->structure.atom_count * sizeof(AtomInstance));
+
+    hiz_begin(&mol->hiz, mvp);
+
+    shader_use(shaders->atom);
+    shader_setUniformMat4(shaders->atom, SHADER_UNIFORM_MODEL, mol->model);
+
+    int l = MOL_LOD_COUNT - 1;
+    glBindVertexArray(mol->atomLodVAO[l]);
+    bind_atom_instances(0);
+    glDrawElementsInstanced(GL_TRIANGLES, unitSpheres[l].index_count, MESH_INDEX_TYPE, 0, count);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    hiz_end(&mol->hiz, shaders->hiz_reduce);
+}
+
+void molecule_draw(Molecule *mol, MoleculeShaders *shaders, mat4 view, mat4 projection)
+{
+    memset(&mol->stats, 0, sizeof(mol->stats));
+    if (!mol->atom_visible || !mol->bond_visible)
+        return;
+
+    // the previous frame's overdraw query is done by now
+    int previous = (mol->overdraw_frame + 1) & 1;
+    if (mol->overdraw_begun[previous])
+    {
+        GLuint samples = 0;
+        glGetQueryObjectuiv(mol->overdrawQueries[previous], GL_QUERY_RESULT, &samples);
+        mol->stats.atom_fragments = samples;
+        mol->overdraw_begun[previous] = 0;
+    }
+
+    mat4 modelView;
+    glm_mat4_mul(view, mol->model, modelView);
+
+    // projection[1][1] = 1 / tan(fovy / 2), so this maps molecule-space radius / view depth to pixels
+    float pixelScale = projection[1][1] * mol->viewport[1] * 0.5f * mol->scale;
+
+    // frustum in molecule space, the instances are never transformed on the CPU
+    mat4 mvp;
+    vec4 planes[6];
+    glm_mat4_mul(projection, modelView, mvp);
+    glm_frustum_planes(mvp, planes);
+
+    // GPU culling keeps the visible atoms on the GPU, so they cannot serve as occluders
+    int gpuCulling = mol->gpu_culling && shaders->atom_cull;
+    int occlusionCulling = mol->occlusion && !gpuCulling && shaders->hiz_reduce &&
+                           hiz_resize(&mol->hiz, mol->viewport[0], mol->viewport[1]) == 0;
+
+    // tested against last frame's visible atoms, with the matrices they were drawn with
+    BvhLeafTest test = NULL;
+    OcclusionTest occlusion = {&mol->hiz, &mol->stats};
+    if (occlusionCulling)
+    {
+        hiz_update(&mol->hiz);
+        if (mol->hiz.valid)
+            test = occlusion_test;
+    }
+
+    if (!gpuCulling)
+        mol->stats.atoms_visible = bvh_cull(&mol->atom_bvh, mol->atom_bounds, planes, test, &occlusion, mol->atom_visible);
+    mol->stats.bonds_visible = bvh_cull(&mol->bond_bvh, mol->bond_bounds, planes, test, &occlusion, mol->bond_visible);
+
+    if (occlusionCulling)
+        render_occluders(mol, shaders, mvp);
+
+    // front to back lets the depth test reject hidden atom fragments before shading
+    if (mol->depth_sort && !gpuCulling)
+    {
+        mol->stats.atoms_resorted = depthsort_update(&mol->atom_sort, mol->atom_bounds, modelView);
+        depthsort_apply(&mol->atom_sort, mol->atom_visible, mol->stats.atoms_visible);
+    }
+
+    int bonds = mol->stats.bonds_visible;
+    if (mol->bond_style == BOND_STYLE_IMPOSTOR && bonds > 0)
+    {
+        gather(mol->bond_instances, mol->bond_visible, mol->bond_frame, sizeof(BondInstance), bonds);
+        stream_frame(mol->bondFrameVBO, mol->bond_frame, bonds * sizeof(BondInstance), mol->bond_instance_count * sizeof(BondInstance));
+
+        shader_use(shaders->bond_impostor);
+        shader_setUniformMat4(shaders->bond_impostor, SHADER_UNIFORM_MODEL, mol->model);
+
+        glBindVertexArray(mol->bondImpostorVAO);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 14, bonds);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        mol->stats.draw_calls++;
+        mol->stats.triangles += 12L * bonds;
     }
+    else if (bonds > 0)
+    {
+        shader_use(shaders->bond);
+        shader_setUniformMat4(shaders->bond, SHADER_UNIFORM_MODEL, mol->model);
+        shader_setUniformMat3(shaders->bond, SHADER_UNIFORM_NORMAL_MATRIX, mol->normal);
+
+        draw_bond_meshes(mol, modelView, pixelScale);
+    }
+
+    // visible atoms into atomFrameVBO, per level of detail for meshes
+    int first[MOL_LOD_COUNT + 1];
+    int impostors = mol->atom_style == ATOM_STYLE_IMPOSTOR;
+    if (gpuCulling)
+    {
+        mol->stats.atoms_visible = cull_atoms_gpu(mol, shaders->atom_cull, modelView, planes, pixelScale, impostors ? 1 : MOL_LOD_COUNT, first);
+    }
+    else if (impostors)
+    {
+        int atoms = mol->stats.atoms_visible;
+        gather(mol->atom_instances, mol->atom_visible, mol->atom_frame, sizeof(AtomInstance), atoms);
+        stream_frame(mol->atomFrameVBO, mol->atom_frame, atoms * sizeof(AtomInstance), mol->structure.atom_count * sizeof(AtomInstance));
+    }
+    else
+    {
+        bucket_atoms(mol, modelView, pixelScale, first);
+    }
+
+    int slot = mol->overdraw_frame & 1;
+    if (mol->overdraw_stats)
+        glBeginQuery(GL_SAMPLES_PASSED, mol->overdrawQueries[slot]);
+
+    int atoms = mol->stats.atoms_visible;
+    if (impostors && atoms > 0)
+    {
+        shader_use(shaders->atom_impostor);
+        shader_setUniformMat4(shaders->atom_impostor, SHADER_UNIFORM_MODEL, mol->model);
+
+        glBindVertexArray(mol->atomImpostorVAO);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, atoms);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        mol->stats.draw_calls++;
+        mol->stats.triangles += 2L * atoms;
+    }
+    else if (atoms > 0)
+    {
+        shader_use(shaders->atom);
+        shader_setUniformMat4(shaders->atom, SHADER_UNIFORM_MODEL, mol->model);
+        shader_setUniformMat3(shaders->atom, SHADER_UNIFORM_NORMAL_MATRIX, mol->normal);
+
+        draw_atom_meshes(mol, first);
+    }
+
+    if (mol->overdraw_stats)
+    {
+        glEndQuery(GL_SAMPLES_PASSED);
+        mol->overdraw_begun[slot] = 1;
+    }
+    mol->overdraw_frame++;
+}
+
+void molecule_printMemory(Molecule *mol, const char *stage)
+{
+    Arena *arena = &mol->arena;
+    printf("%s (%s): %d atoms, %d bonds - %ld allocations, %zu bytes used, %zu held in %d chunks, high-water %zu\n",
+           mol->name, stage, mol->structure.atom_count, mol->structure.bond_count, arena->allocations,
+           arena->used, arena->reserved, arena->chunks, arena->high_water);
+
+    // meshes are GL handles only, their vertices live on the GPU
+    printf("%s (%s): %zu resident CPU bytes (%zu molecule + %zu arena), shared unit meshes %zu bytes\n",
+           mol->name, stage, sizeof(Molecule) + arena->reserved, sizeof(Molecule), arena->reserved,
+           sizeof(unitSpheres) + sizeof(unitCylinders));
+};
+
+void molecule_delete(Molecule *mol)
+{
+    structure_delete(&mol->structure);
+
+    // structure, instance arrays and the rest of the CPU side in one release
+    arena_delete(&mol->arena);
+    mol->atom_instances = NULL;
+    mol->atom_bounds = NULL;
+    mol->atom_visible = NULL;
+    mol->atom_frame = NULL;
+    mol->atom_lod = NULL;
+    memset(&mol->atom_bvh, 0, sizeof(Bvh));
+    memset(&mol->atom_sort, 0, sizeof(DepthSort));
+    mol->bond_instances = NULL;
+    mol->bond_bounds = NULL;
+    mol->bond_visible = NULL;
+    mol->bond_frame = NULL;
+    mol->bond_lod = NULL;
+    memset(&mol->bond_bvh, 0, sizeof(Bvh));
+
+    if (mol->uploaded)
+        release_gpu(mol);
 }
@@ -1,19 +1,36 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 #include <cglm/cglm.h>
 #include <cjson/cJSON.h>
+#include <arena.h>
 #include <molecule.h>
+#include <parse.h>
+#include <bonds.h>
 
-// Default Atom Properties
-AtomProp Hydrogen = ATOM_PROP(1.0f, 1.0f, 1.0f, 0.2f);   // White
-AtomProp Carbon = ATOM_PROP(0.2f, 0.2f, 0.2f, 0.3f);     // Dark Gray
-AtomProp Nitrogen = ATOM_PROP(0.0f, 0.0f, 1.0f, 0.25f);  // Blue
-AtomProp Oxygen = ATOM_PROP(1.0f, 0.0f, 0.0f, 0.25f);    // Red
-AtomProp Sulfur = ATOM_PROP(1.0f, 1.0f, 0.0f, 0.3f);     // Yellow
-AtomProp Phosphorus = ATOM_PROP(1.0f, 0.5f, 0.0f, 0.3f); // Orange
+// Default bond properties
 AtomProp BondT = ATOM_PROP(0.5f, 0.5f, 0.5f, 0.08f);
 
+// bond type, color and radius of a molfile bond order, multi-bonds get thinner lines
+BondType bond_order_props(int order, vec3 color, float *radius)
+{
+    glm_vec3_copy(BondT.color, color);
+    *radius = BondT.radius;
+
+    if (order == 2)
+    {
+        *radius = BondT.radius * 0.75f;
+        return DOUBLE_BOND;
+    }
+    if (order == 3)
+    {
+        *radius = BondT.radius * 0.5f;
+        return TRIPLE_BOND;
+    }
+    return SINGLE_BOND; // single or fallback
+}
+
 void load_molecule_from_JSON(const char *filename, Molecule *mol)
 {
     // printf("Starting to load molecule from JSON...\n");
@@ -28,7 +45,11 @@ void load_molecule_from_JSON(const char *filename, Molecule *mol)
     long len = ftell(fp);
     fseek(fp, 0, SEEK_SET);
 
-    char *data = malloc(len + 1);
+    // the file text and every cJSON node live in a scratch arena, released in one go
+    Arena scratch;
+    arena_init(&scratch, len + 1 + ARENA_CHUNK_SIZE);
+
+    char *data = arena_alloc(&scratch, len + 1);
     if (!data)
     {
         fclose(fp);
@@ -39,18 +60,20 @@ void load_molecule_from_JSON(const char *filename, Molecule *mol)
     if (fread(data, 1, len, fp) != (size_t)len)
     {
         printf("Failed to read file\n");
-        free(data);
+        arena_delete(&scratch);
         fclose(fp);
         return;
     }
     data[len] = '\0';
     fclose(fp);
 
+    arena_useForJSON(&scratch);
     cJSON *json = cJSON_Parse(data);
-    free(data);
+    arena_useForJSON(NULL);
     if (!json)
     {
         printf("Error parsing JSON\n");
+        arena_delete(&scratch);
         return;
     }
 
@@ -60,21 +83,14 @@ void load_molecule_from_JSON(const char *filename, Molecule *mol)
     if (!cJSON_IsNumber(atomCountItem) || !cJSON_IsNumber(bondCountItem))
     {
         printf("Invalid counts in JSON\n");
-        cJSON_Delete(json);
+        arena_delete(&scratch);
         return;
     }
-    mol->atom_count = atomCountItem->valueint;
-    mol->bond_count = bondCountItem->valueint;
-
-    // Allocate for Atom + Bond Arrays
-    mol->atoms = malloc(sizeof(Atom) * mol->atom_count);
-    mol->bonds = malloc(sizeof(Bond) * mol->bond_count);
-    if (!mol->atoms || !mol->bonds)
+    // Allocate the atom + bond arrays
+    Structure *s = &mol->structure;
+    if (structure_init(s, &mol->arena, atomCountItem->valueint, bondCountItem->valueint) != 0)
     {
-        printf("Memory allocation error for atoms or bonds\n");
-        cJSON_Delete(json);
-        free(mol->atoms);
-        free(mol->bonds);
+        arena_delete(&scratch);
         return;
     }
 
@@ -83,9 +99,8 @@ void load_molecule_from_JSON(const char *filename, Molecule *mol)
     if (!cJSON_IsArray(atomsArray))
     {
         printf("Atoms is not an array\n");
-        cJSON_Delete(json);
-        free(mol->atoms);
-        free(mol->bonds);
+        arena_delete(&scratch);
+        structure_delete(s);
         return;
     }
 
@@ -93,6 +108,9 @@ void load_molecule_from_JSON(const char *filename, Molecule *mol)
     cJSON *atomItem = NULL;
     cJSON_ArrayForEach(atomItem, atomsArray)
     {
+        if (i == s->atom_count)
+            break;
+
         cJSON *xItem = cJSON_GetObjectItem(atomItem, "x");
         cJSON *yItem = cJSON_GetObjectItem(atomItem, "y");
         cJSON *zItem = cJSON_GetObjectItem(atomItem, "z");
@@ -106,36 +124,12 @@ void load_molecule_from_JSON(const char *filename, Molecule *mol)
         vec3 pos = {(float)xItem->valuedouble, (float)yItem->valuedouble, (float)zItem->valuedouble};
 
         // Set atom properties based on element type
+        int element = element_id(elementItem->valuestring);
         vec3 color;
         float radius;
-        if (strcmp(elementItem->valuestring, "H") == 0)
-        {
-            glm_vec3_copy(Hydrogen.color, color);
-            radius = Hydrogen.radius;
-        }
-        else if (strcmp(elementItem->valuestring, "C") == 0)
-        {
-            glm_vec3_copy(Carbon.color, color);
-            radius = Carbon.radius;
-        }
-        else if (strcmp(elementItem->valuestring, "N") == 0)
-        {
-            glm_vec3_copy(Nitrogen.color, color);
-            radius = Nitrogen.radius;
-        }
-        else if (strcmp(elementItem->valuestring, "O") == 0)
-        {
-            glm_vec3_copy(Oxygen.color, color);
-            radius = Oxygen.radius;
-        }
-        else
-        {
-            // Default fallback
-            glm_vec3_copy(Hydrogen.color, color);
-            radius = Hydrogen.radius;
-        }
+        element_props(element, color, &radius);
 
-        atom_init(&mol->atoms[i], elementItem->valuestring, pos, color, radius);
+        structure_setAtom(s, i, element, pos, color, radius);
 
         i++;
     }
@@ -145,9 +139,8 @@ void load_molecule_from_JSON(const char *filename, Molecule *mol)
     if (!cJSON_IsArray(bondsArray))
     {
         printf("Bonds is not an array\n");
-        cJSON_Delete(json);
-        free(mol->atoms);
-        free(mol->bonds);
+        arena_delete(&scratch);
+        structure_delete(s);
         return;
     }
 
@@ -155,6 +148,9 @@ void load_molecule_from_JSON(const char *filename, Molecule *mol)
     cJSON *bondItem = NULL;
     cJSON_ArrayForEach(bondItem, bondsArray)
     {
+        if (i == s->bond_count)
+            break;
+
         cJSON *atom1Item = cJSON_GetObjectItem(bondItem, "atom1");
         cJSON *atom2Item = cJSON_GetObjectItem(bondItem, "atom2");
         cJSON *bondTypeItem = cJSON_GetObjectItem(bondItem, "bond_type");
@@ -167,42 +163,318 @@ void load_molecule_from_JSON(const char *filename, Molecule *mol)
         int idx1 = atom1Item->valueint;
         int idx2 = atom2Item->valueint;
         // 1-based index to 0-based index
-        if (idx1 < 1 || idx1 > mol->atom_count || idx2 < 1 || idx2 > mol->atom_count)
+        if (idx1 < 1 || idx1 > s->atom_count || idx2 < 1 || idx2 > s->atom_count)
         {
             printf("Bond atom index out of range\n");
             continue;
         }
-        Atom *a1 = &mol->atoms[idx1 - 1];
-        Atom *a2 = &mol->atoms[idx2 - 1];
+        structure_setBond(s, i, idx1 - 1, idx2 - 1, bondTypeItem->valueint);
+        i++;
+    }
+    s->bond_count = i; // skipped bonds leave no gaps
 
-        // Map bond_type from JSON to your enum
-        int bt = bondTypeItem->valueint;
+    arena_delete(&scratch);
+    return;
+}
+
+// next line of [*cursor, end), without its line terminator
+static int next_line(const char **cursor, const char *end, const char **line, int *len)
+{
+    if (*cursor >= end)
+        return 0;
+
+    const char *start = *cursor;
+    const char *nl = memchr(start, '\n', end - start);
+    const char *stop = nl ? nl : end;
 
+    *cursor = nl ? nl + 1 : end;
+    *line = start;
+    *len = (int)(stop - start);
+    if (*len > 0 && start[*len - 1] == '\r')
+        (*len)--;
+    return 1;
+}
+
+// copies the fixed-width column [start, start + width) of a line, trimmed of spaces
+static int mol_field(const char *line, int len, int start, int width, char *out, int size)
+{
+    int n = 0;
+    for (int c = start; c < start + width && c < len && n < size - 1; c++)
+    {
+        if (line[c] != ' ')
+            out[n++] = line[c];
+    }
+    out[n] = '\0';
+    return n;
+}
+
+static int mol_int(const char *line, int len, int start, int width, int *value)
+{
+    char buf[16];
+    char *endp;
+    if (mol_field(line, len, start, width, buf, sizeof(buf)) == 0)
+        return -1;
+    *value = (int)strtol(buf, &endp, 10);
+    return *endp == '\0' ? 0 : -1;
+}
+
+static int mol_float(const char *line, int len, int start, int width, float *value)
+{
+    char buf[16];
+    char *endp;
+    if (mol_field(line, len, start, width, buf, sizeof(buf)) == 0)
+        return -1;
+    *value = strtof(buf, &endp);
+    return *endp == '\0' ? 0 : -1;
+}
+
+int parse_molfile(const char *data, size_t size, Molecule *mol)
+{
+    const char *cursor = data;
+    const char *end = data + size;
+    const char *line;
+    int len;
+
+    Structure *s = &mol->structure;
+    memset(s, 0, sizeof(Structure));
+
+    // header block: name, program/timestamp, comment
+    for (int i = 0; i < 3; i++)
+    {
+        if (!next_line(&cursor, end, &line, &len))
+        {
+            printf("Truncated molfile header\n");
+            return -1;
+        }
+    }
+
+    // counts line: aaabbb...V2000
+    int atom_count, bond_count;
+    if (!next_line(&cursor, end, &line, &len) ||
+        mol_int(line, len, 0, 3, &atom_count) < 0 || mol_int(line, len, 3, 3, &bond_count) < 0 ||
+        atom_count < 0 || bond_count < 0)
+    {
+        printf("Invalid molfile counts line\n");
+        return -1;
+    }
+    if (len >= 39 && memcmp(line + 34, "V3000", 5) == 0)
+    {
+        printf("V3000 molfiles are not supported\n");
+        return -1;
+    }
+
+    if (structure_init(s, &mol->arena, atom_count, bond_count) != 0)
+    {
+        return -1;
+    }
+
+    // atom block: xxxxx.xxxxyyyyy.yyyyzzzzz.zzzz aaa
+    for (int i = 0; i < atom_count; i++)
+    {
+        vec3 pos;
+        char symbol[4];
+        if (!next_line(&cursor, end, &line, &len) ||
+            mol_float(line, len, 0, 10, &pos[0]) < 0 ||
+            mol_float(line, len, 10, 10, &pos[1]) < 0 ||
+            mol_float(line, len, 20, 10, &pos[2]) < 0 ||
+            mol_field(line, len, 31, 3, symbol, sizeof(symbol)) == 0)
+        {
+            printf("Invalid molfile atom line %d\n", i + 1);
+            goto fail;
+        }
+
+        int element = element_id(symbol);
         vec3 color;
-        glm_vec3_copy(BondT.color, color);
-        float radius = BondT.radius;
-        BondType type;
-        if (bt == 1)
+        float radius;
+        element_props(element, color, &radius);
+        structure_setAtom(s, i, element, pos, color, radius);
+    }
+
+    // bond block: 111222ttt
+    int n = 0;
+    for (int i = 0; i < bond_count; i++)
+    {
+        int idx1, idx2, order;
+        if (!next_line(&cursor, end, &line, &len) ||
+            mol_int(line, len, 0, 3, &idx1) < 0 ||
+            mol_int(line, len, 3, 3, &idx2) < 0 ||
+            mol_int(line, len, 6, 3, &order) < 0)
+        {
+            printf("Invalid molfile bond line %d\n", i + 1);
+            goto fail;
+        }
+
+        // 1-based index to 0-based index
+        if (idx1 < 1 || idx1 > atom_count || idx2 < 1 || idx2 > atom_count)
         {
-            type = SINGLE_BOND;
+            printf("Bond atom index out of range\n");
+            continue;
         }
-        else if (bt == 2)
+
+        structure_setBond(s, n++, idx1 - 1, idx2 - 1, order);
+    }
+    s->bond_count = n; // skipped bonds leave no gaps
+
+    return 0;
+
+fail:
+    structure_delete(s);
+    return -1;
+}
+
+int parse_xyz(const char *data, size_t size, Molecule *mol)
+{
+    const char *cursor = data;
+    const char *end = data + size;
+    const char *line;
+    int len;
+    char buf[256];
+
+    Structure *s = &mol->structure;
+    memset(s, 0, sizeof(Structure));
+
+    // atom count, then a free-form comment line
+    int atom_count;
+    char *endp;
+    if (!next_line(&cursor, end, &line, &len) || len >= (int)sizeof(buf))
+    {
+        printf("Invalid xyz atom count\n");
+        return -1;
+    }
+    memcpy(buf, line, len);
+    buf[len] = '\0';
+    atom_count = (int)strtol(buf, &endp, 10);
+    if (endp == buf || atom_count < 0 || !next_line(&cursor, end, &line, &len))
+    {
+        printf("Invalid xyz atom count\n");
+        return -1;
+    }
+
+    if (structure_init(s, &mol->arena, atom_count, 0) != 0)
+    {
+        return -1;
+    }
+
+    // atom lines: symbol (or atomic number) x y z, anything after is ignored
+    for (int i = 0; i < atom_count; i++)
+    {
+        vec3 pos;
+        char symbol[8];
+        if (!next_line(&cursor, end, &line, &len) || len >= (int)sizeof(buf))
         {
-            type = DOUBLE_BOND;
-            radius = radius * 0.75f;
+            printf("Invalid xyz atom line %d\n", i + 1);
+            goto fail;
         }
-        else if (bt == 3)
+        memcpy(buf, line, len);
+        buf[len] = '\0';
+        if (sscanf(buf, "%7s %f %f %f", symbol, &pos[0], &pos[1], &pos[2]) != 4)
         {
-            type = TRIPLE_BOND;
-            radius = radius * 0.5f;
+            printf("Invalid xyz atom line %d\n", i + 1);
+            goto fail;
         }
-        else
-            type = SINGLE_BOND; // fallback
 
-        bond_init(&mol->bonds[i], type, a1, a2, color, radius);
-        i++;
+        int element = isdigit((unsigned char)symbol[0]) ? atoi(symbol) : element_id(symbol);
+        if (element < 0 || element >= ELEMENT_COUNT)
+            element = 0;
+        vec3 color;
+        float radius;
+        element_props(element, color, &radius);
+        structure_setAtom(s, i, element, pos, color, radius);
     }
 
-    cJSON_Delete(json);
-    return;
-}
\ No newline at end of file
+    // xyz carries no connectivity
+    if (bonds_perceive(s) < 0)
+        goto fail;
+    return 0;
+
+fail:
+    structure_delete(s);
+    return -1;
+}
+
+// reads a whole stream (file or pipe) into a heap buffer
+static char *read_stream(FILE *fp, size_t *size)
+{
+    size_t capacity = 16 * 1024;
+    size_t len = 0;
+    char *data = malloc(capacity);
+    if (!data)
+    {
+        printf("Memory not available\n");
+        return NULL;
+    }
+
+    size_t n;
+    while ((n = fread(data + len, 1, capacity - len, fp)) > 0)
+    {
+        len += n;
+        if (len == capacity)
+        {
+            char *grown = realloc(data, capacity * 2);
+            if (!grown)
+            {
+                printf("Memory not available\n");
+                free(data);
+                return NULL;
+            }
+            data = grown;
+            capacity *= 2;
+        }
+    }
+
+    if (ferror(fp))
+    {
+        printf("Failed to read stream\n");
+        free(data);
+        return NULL;
+    }
+
+    *size = len;
+    return data;
+}
+
+int load_molecule_from_stream(FILE *fp, Molecule *mol)
+{
+    size_t size;
+    char *data = read_stream(fp, &size);
+    if (!data)
+        return -1;
+
+    int result = parse_molfile(data, size, mol);
+    free(data);
+    return result;
+}
+
+int load_molecule_from_molfile(const char *filename, Molecule *mol)
+{
+    FILE *fp = fopen(filename, "rb");
+    if (!fp)
+    {
+        printf("Unable to open molfile: %s\n", filename);
+        return -1;
+    }
+
+    int result = load_molecule_from_stream(fp, mol);
+    fclose(fp);
+    return result;
+}
+
+int load_molecule_from_xyz(const char *filename, Molecule *mol)
+{
+    FILE *fp = fopen(filename, "rb");
+    if (!fp)
+    {
+        printf("Unable to open xyz file: %s\n", filename);
+        return -1;
+    }
+
+    size_t size;
+    char *data = read_stream(fp, &size);
+    fclose(fp);
+    if (!data)
+        return -1;
+
+    int result = parse_xyz(data, size, mol);
+    free(data);
+    return result;
+}
@@ -0,0 +1,176 @@
+#include <string.h>
+#include <pthread.h>
+#include <radix.h>
+
+#define RADIX_BUCKETS (1 << RADIX_DIGIT_BITS)
+
+typedef struct RadixSort RadixSort;
+
+// one thread's range [begin, end) of every pass
+typedef struct
+{
+    RadixSort *sort;
+    int index;
+    int begin, end;
+    int offsets[RADIX_BUCKETS]; // digit counts, then the first destination of each digit
+} RadixWorker;
+
+struct RadixSort
+{
+    unsigned int *keys, *scratch_keys;
+    int *items, *scratch_items;
+    int count;
+    int key_bits;
+    int threadCount;
+
+    // barrier between the steps of a pass
+    pthread_mutex_t lock;
+    pthread_cond_t arrived;
+    int arrivedCount;
+    int generation;
+
+    RadixWorker workers[RADIX_MAX_THREADS];
+};
+
+static void barrier_wait(RadixSort *sort)
+{
+    if (sort->threadCount == 1)
+        return;
+
+    pthread_mutex_lock(&sort->lock);
+    int generation = sort->generation;
+    if (++sort->arrivedCount == sort->threadCount)
+    {
+        sort->arrivedCount = 0;
+        sort->generation++;
+        pthread_cond_broadcast(&sort->arrived);
+    }
+    else
+    {
+        while (generation == sort->generation)
+            pthread_cond_wait(&sort->arrived, &sort->lock);
+    }
+    pthread_mutex_unlock(&sort->lock);
+}
+
+static void run_passes(RadixWorker *worker)
+{
+    RadixSort *sort = worker->sort;
+    worker->begin = (int)((long long)sort->count * worker->index / sort->threadCount);
+    worker->end = (int)((long long)sort->count * (worker->index + 1) / sort->threadCount);
+
+    const unsigned int *keys = sort->keys;
+    const int *items = sort->items;
+    unsigned int *dstKeys = sort->scratch_keys;
+    int *dstItems = sort->scratch_items;
+
+    for (int shift = 0; shift < sort->key_bits; shift += RADIX_DIGIT_BITS)
+    {
+        memset(worker->offsets, 0, sizeof(worker->offsets));
+        for (int i = worker->begin; i < worker->end; i++)
+        {
+            worker->offsets[(keys[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+        }
+        barrier_wait(sort);
+
+        // digit-major, then range order, keeps the sort stable
+        if (worker->index == 0)
+        {
+            int next = 0;
+            for (int d = 0; d < RADIX_BUCKETS; d++)
+            {
+                for (int t = 0; t < sort->threadCount; t++)
+                {
+                    int digitCount = sort->workers[t].offsets[d];
+                    sort->workers[t].offsets[d] = next;
+                    next += digitCount;
+                }
+            }
+        }
+        barrier_wait(sort);
+
+        for (int i = worker->begin; i < worker->end; i++)
+        {
+            int slot = worker->offsets[(keys[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+            dstKeys[slot] = keys[i];
+            dstItems[slot] = items[i];
+        }
+        // the next pass reads what every range wrote
+        barrier_wait(sort);
+
+        const unsigned int *tmpKeys = keys;
+        keys = dstKeys;
+        dstKeys = (unsigned int *)tmpKeys;
+        const int *tmpItems = items;
+        items = dstItems;
+        dstItems = (int *)tmpItems;
+    }
+}
+
+static void *sort_thread(void *arg)
+{
+    RadixWorker *worker = arg;
+    barrier_wait(worker->sort); // until every thread started and threadCount is final
+    run_passes(worker);
+    return NULL;
+}
+
+void radix_sort(unsigned int *keys, int *items, unsigned int *scratch_keys, int *scratch_items, int count, int key_bits)
+{
+    RadixSort sort;
+    sort.keys = keys;
+    sort.items = items;
+    sort.scratch_keys = scratch_keys;
+    sort.scratch_items = scratch_items;
+    sort.count = count;
+    sort.key_bits = key_bits;
+    sort.threadCount = 1;
+    sort.arrivedCount = 0;
+    sort.generation = 0;
+    for (int t = 0; t < RADIX_MAX_THREADS; t++)
+    {
+        sort.workers[t].sort = &sort;
+        sort.workers[t].index = t;
+    }
+
+    if (count < RADIX_SERIAL_COUNT)
+    {
+        run_passes(&sort.workers[0]);
+    }
+    else
+    {
+        // threads live for the whole sort, a thread that could not start shrinks the split
+        pthread_t threads[RADIX_MAX_THREADS];
+        int started = 0;
+        pthread_mutex_init(&sort.lock, NULL);
+        pthread_cond_init(&sort.arrived, NULL);
+
+        pthread_mutex_lock(&sort.lock);
+        sort.threadCount = RADIX_MAX_THREADS;
+        while (started + 1 < RADIX_MAX_THREADS &&
+               pthread_create(&threads[started + 1], NULL, sort_thread, &sort.workers[started + 1]) == 0)
+        {
+            started++;
+        }
+        sort.threadCount = started + 1;
+        pthread_mutex_unlock(&sort.lock);
+
+        barrier_wait(&sort);
+        run_passes(&sort.workers[0]);
+        for (int t = 1; t <= started; t++)
+        {
+            pthread_join(threads[t], NULL);
+        }
+
+        pthread_cond_destroy(&sort.arrived);
+        pthread_mutex_destroy(&sort.lock);
+    }
+
+    // an odd pass count leaves the result in the scratch arrays
+    int passes = (key_bits + RADIX_DIGIT_BITS - 1) / RADIX_DIGIT_BITS;
+    if (passes % 2 == 1)
+    {
+        memcpy(keys, scratch_keys, count * sizeof(unsigned int));
+        memcpy(items, scratch_items, count * sizeof(int));
+    }
+}
@@ -1,8 +1,23 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <shader.h>
 #include <glad/glad.h>
 
+#define SHADER_SOURCE_SIZE 4096
+
+// names of the ShaderUniform slots
+static const char *uniformNames[SHADER_UNIFORM_COUNT] = {
+    "model",
+    "normalMatrix",
+    "text",
+    "textColor",
+    "modelView",
+    "planes[0]", // arrays are reflected by their first element
+    "pixelScale",
+    "pixelRange",
+};
+
 int read_from_file(const char *filePath, char *srcCode, size_t bufferSize)
 {
     FILE *src = fopen(filePath, "rb");
@@ -32,10 +47,44 @@ int read_from_file(const char *filePath, char *srcCode, size_t bufferSize)
     return fileSize <= bufferSize ? 0 : -1;
 }
 
+// cache uniform locations and bind the "Frame" block so the draw loop never looks names up
+static void shader_reflect(Shader *sh)
+{
+    int count = 0;
+    glGetProgramiv(sh->ID, GL_ACTIVE_UNIFORMS, &count);
+
+    sh->uniform_count = 0;
+    for (int i = 0; i < count && sh->uniform_count < SHADER_MAX_UNIFORMS; i++)
+    {
+        ShaderUniformInfo *info = &sh->uniforms[sh->uniform_count];
+        int size;
+        GLenum type;
+        glGetActiveUniform(sh->ID, i, sizeof(info->name), NULL, &size, &type, info->name);
+
+        // uniforms inside blocks have no location
+        info->location = glGetUniformLocation(sh->ID, info->name);
+        if (info->location >= 0)
+        {
+            sh->uniform_count++;
+        }
+    }
+
+    for (int u = 0; u < SHADER_UNIFORM_COUNT; u++)
+    {
+        sh->locations[u] = shader_getLocation(sh, uniformNames[u]);
+    }
+
+    unsigned int frameIndex = glGetUniformBlockIndex(sh->ID, "Frame");
+    if (frameIndex != GL_INVALID_INDEX)
+    {
+        glUniformBlockBinding(sh->ID, frameIndex, SHADER_FRAME_BINDING);
+    }
+}
+
 Shader *shader_create(const char *vertexPath, const char *fragmentPath)
 {
-    char *vertexCode = malloc(1024);
-    char *fragmentCode = malloc(1024);
+    char *vertexCode = malloc(SHADER_SOURCE_SIZE);
+    char *fragmentCode = malloc(SHADER_SOURCE_SIZE);
     if (!vertexCode || !fragmentCode)
     {
         fprintf(stderr, "Memory allocation failed\n");
@@ -44,7 +93,7 @@ Shader *shader_create(const char *vertexPath, const char *fragmentPath)
         return NULL;
     }
 
-    if (read_from_file(vertexPath, vertexCode, 1024) < 0)
+    if (read_from_file(vertexPath, vertexCode, SHADER_SOURCE_SIZE) < 0)
     {
         printf("Error reading vertex shader file\n");
         free(vertexCode);
@@ -52,7 +101,7 @@ Shader *shader_create(const char *vertexPath, const char *fragmentPath)
         return NULL;
     }
 
-    if (read_from_file(fragmentPath, fragmentCode, 1024) < 0)
+    if (read_from_file(fragmentPath, fragmentCode, SHADER_SOURCE_SIZE) < 0)
     {
         printf("Error reading fragment shader file");
         free(vertexCode);
@@ -109,6 +158,78 @@ Shader *shader_create(const char *vertexPath, const char *fragmentPath)
 
     free(vertexCode);
     free(fragmentCode);
+
+    shader_reflect(sh);
+    return sh;
+};
+
+// compiled shader object of a source file, 0 on error
+static unsigned int compile_file(const char *path, GLenum type, const char *stage)
+{
+    char *code = malloc(SHADER_SOURCE_SIZE);
+    if (!code)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        return 0;
+    }
+    if (read_from_file(path, code, SHADER_SOURCE_SIZE) < 0)
+    {
+        printf("Error reading %s shader file\n", stage);
+        free(code);
+        return 0;
+    }
+
+    unsigned int shader = glCreateShader(type);
+    glShaderSource(shader, 1, (const GLchar *const *)&code, NULL);
+    glCompileShader(shader);
+    free(code);
+
+    int success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        char infoLog[512];
+        glGetShaderInfoLog(shader, 512, NULL, infoLog);
+        printf("ERROR::SHADER::%s::COMPILATION_FAILED\n%s\n", stage, infoLog);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+Shader *shader_createFeedback(const char *vertexPath, const char *geometryPath, const char *const *varyings, int varying_count)
+{
+    unsigned int vertex = compile_file(vertexPath, GL_VERTEX_SHADER, "VERTEX");
+    unsigned int geometry = compile_file(geometryPath, GL_GEOMETRY_SHADER, "GEOMETRY");
+    Shader *sh = vertex && geometry ? malloc(sizeof(Shader)) : NULL;
+    if (!sh)
+    {
+        glDeleteShader(vertex);
+        glDeleteShader(geometry);
+        return NULL;
+    }
+
+    // the captured varyings are fixed before linking
+    sh->ID = glCreateProgram();
+    glAttachShader(sh->ID, vertex);
+    glAttachShader(sh->ID, geometry);
+    glTransformFeedbackVaryings(sh->ID, varying_count, (const GLchar *const *)varyings, GL_INTERLEAVED_ATTRIBS);
+    glLinkProgram(sh->ID);
+    glDeleteShader(vertex);
+    glDeleteShader(geometry);
+
+    int success;
+    glGetProgramiv(sh->ID, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        char infoLog[512];
+        glGetProgramInfoLog(sh->ID, 512, NULL, infoLog);
+        printf("ERROR::SHADER::PROGRAM::LINKING_FAILED\n%s\n", infoLog);
+        shader_delete(sh);
+        return NULL;
+    }
+
+    shader_reflect(sh);
     return sh;
 };
 
@@ -117,36 +238,107 @@ void shader_use(const Shader *shader)
     glUseProgram(shader->ID);
 };
 
+int shader_getLocation(const Shader *shader, const char *name)
+{
+    for (int i = 0; i < shader->uniform_count; i++)
+    {
+        if (strcmp(shader->uniforms[i].name, name) == 0)
+        {
+            return shader->uniforms[i].location;
+        }
+    }
+    return -1;
+};
+
 void shader_setBool(const Shader *shader, const char *name, bool value)
 {
     glUseProgram(shader->ID);
-    glUniform1i(glGetUniformLocation(shader->ID, name), value);
+    glUniform1i(shader_getLocation(shader, name), value);
 };
 
 void shader_setInt(const Shader *shader, const char *name, int value)
 {
     glUseProgram(shader->ID);
-    glUniform1i(glGetUniformLocation(shader->ID, name), value);
+    glUniform1i(shader_getLocation(shader, name), value);
 };
 
 void shader_setFloat(const Shader *shader, const char *name, float value)
 {
     glUseProgram(shader->ID);
-    glUniform1f(glGetUniformLocation(shader->ID, name), value);
+    glUniform1f(shader_getLocation(shader, name), value);
 };
 
 void shader_setMat4(const Shader *shader, const char *name, mat4 mat)
 {
     glUseProgram(shader->ID);
-    glUniformMatrix4fv(glGetUniformLocation(shader->ID, name), 1, GL_FALSE, (GLfloat *)mat);
+    glUniformMatrix4fv(shader_getLocation(shader, name), 1, GL_FALSE, (GLfloat *)mat);
 };
 
 void shader_setVec3(const Shader *shader, const char *name, vec3 v)
 {
     glUseProgram(shader->ID);
-    glUniform3fv(glGetUniformLocation(shader->ID, name), 1, v);
+    glUniform3fv(shader_getLocation(shader, name), 1, v);
 }
 
+void shader_setUniformMat4(const Shader *shader, ShaderUniform uniform, mat4 mat)
+{
+    glUniformMatrix4fv(shader->locations[uniform], 1, GL_FALSE, (GLfloat *)mat);
+};
+
+void shader_setUniformMat3(const Shader *shader, ShaderUniform uniform, mat3 mat)
+{
+    glUniformMatrix3fv(shader->locations[uniform], 1, GL_FALSE, (GLfloat *)mat);
+};
+
+void shader_setUniformVec3(const Shader *shader, ShaderUniform uniform, vec3 v)
+{
+    glUniform3fv(shader->locations[uniform], 1, v);
+};
+
+void shader_setUniformInt(const Shader *shader, ShaderUniform uniform, int value)
+{
+    glUniform1i(shader->locations[uniform], value);
+};
+
+void shader_setUniformFloat(const Shader *shader, ShaderUniform uniform, float value)
+{
+    glUniform1f(shader->locations[uniform], value);
+};
+
+void shader_setUniformVec2(const Shader *shader, ShaderUniform uniform, vec2 v)
+{
+    glUniform2fv(shader->locations[uniform], 1, v);
+};
+
+void shader_setUniformVec4Array(const Shader *shader, ShaderUniform uniform, vec4 *v, int count)
+{
+    glUniform4fv(shader->locations[uniform], count, (GLfloat *)v);
+};
+
+unsigned int shader_frameCreate(void)
+{
+    unsigned int ubo;
+    glGenBuffers(1, &ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    glBindBufferBase(GL_UNIFORM_BUFFER, SHADER_FRAME_BINDING, ubo);
+    return ubo;
+};
+
+void shader_frameUpdate(unsigned int ubo, const FrameUniforms *frame)
+{
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), frame);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+};
+
+void shader_frameDelete(unsigned int ubo)
+{
+    glDeleteBuffers(1, &ubo);
+};
+
 void shader_delete(Shader *shader)
 {
     if (shader)
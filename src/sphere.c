@@ -1,146 +1,130 @@
+#include <stdlib.h>
 #include <sphere.h>
+#include <meshopt.h>
 
-void sphere_gen_stacks_sectors(Sphere *sphere)
+void sphere_gen_stacks_sectors(Sphere *sphere, PositionVertex *vertices)
 {
-    const float sectorStep = 2 * SP_PI / SECTOR_COUNT;
-    const float stackStep = SP_PI / STACK_COUNT;
-    float lengthInv = -1.0f / sphere->radius;
+    const float sectorStep = 2 * SP_PI / sphere->sectors;
+    const float stackStep = SP_PI / sphere->stacks;
     float sectorAngle, stackAngle; // (theta, phi)
 
     int vi = 0;
 
-    for (int i = 0; i <= STACK_COUNT; i++)
+    for (int i = 0; i <= sphere->stacks; i++)
     {
         stackAngle = (SP_PI / 2) - i * stackStep;
-        float xy = sphere->radius * cos(stackAngle);
-        float z = sphere->radius * sin(stackAngle);
+        float xy = cos(stackAngle);
+        float z = sin(stackAngle);
 
-        for (int j = 0; j <= SECTOR_COUNT; j++)
+        for (int j = 0; j <= sphere->sectors; j++)
         {
             sectorAngle = j * sectorStep;
             float x, y;
             x = xy * cos(sectorAngle);
             y = xy * sin(sectorAngle);
 
-            sphere->vertices[vi++] = x;
-            sphere->vertices[vi++] = y;
-            sphere->vertices[vi++] = z;
-
-            sphere->vertices[vi++] = sphere->color[0];
-            sphere->vertices[vi++] = sphere->color[1];
-            sphere->vertices[vi++] = sphere->color[2];
-
-            // normals
-            sphere->vertices[vi++] = x * lengthInv;
-            sphere->vertices[vi++] = y * lengthInv;
-            sphere->vertices[vi++] = z * lengthInv;
+            // the shader derives the (inward facing) normal from the position
+            vertex_packPosition((vec3){x, y, z}, vertices[vi++].position);
         };
     };
 
     // printf("size of vertices:%d\n", vi);
 };
 
-void sphere_gen_indices(Sphere *sphere)
+void sphere_gen_indices(Sphere *sphere, MeshIndex *indices)
 {
     int vi = 0;
 
-    for (int i = 0; i < STACK_COUNT; i++)
+    for (int i = 0; i < sphere->stacks; i++)
     {
-        int k1 = i * (SECTOR_COUNT + 1);
-        int k2 = k1 + SECTOR_COUNT + 1;
+        int k1 = i * (sphere->sectors + 1);
+        int k2 = k1 + sphere->sectors + 1;
 
-        for (int j = 0; j < SECTOR_COUNT; j++, k1++, k2++)
+        for (int j = 0; j < sphere->sectors; j++, k1++, k2++)
         {
             if (i != 0)
             {
-                sphere->indices[vi++] = k1;
-                sphere->indices[vi++] = k2;
-                sphere->indices[vi++] = k1 + 1;
+                indices[vi++] = k1;
+                indices[vi++] = k2;
+                indices[vi++] = k1 + 1;
             };
 
-            if (i != STACK_COUNT - 1)
+            if (i != sphere->stacks - 1)
             {
-                sphere->indices[vi++] = k1 + 1;
-                sphere->indices[vi++] = k2;
-                sphere->indices[vi++] = k2 + 1;
+                indices[vi++] = k1 + 1;
+                indices[vi++] = k2;
+                indices[vi++] = k2 + 1;
             };
         };
     };
 
+    sphere->index_count = vi;
     // printf("size of indices:%d\n", vi);
 };
 
-void sphere_init(Sphere *sphere, vec3 position, vec3 color, float radius)
+void sphere_init(Sphere *sphere, int stacks, int sectors)
 {
-    glm_vec3_copy(position, sphere->position);
-    glm_vec3_copy(color, sphere->color);
-    sphere->radius = radius;
-    sphere->angle = 0.0f;
-
-    sphere_gen_stacks_sectors(sphere);
-    sphere_gen_indices(sphere);
+    sphere->stacks = glm_clamp(stacks, 2, STACK_COUNT);
+    sphere->sectors = glm_clamp(sectors, 3, SECTOR_COUNT);
+
+    // transient, the GPU keeps the only copy
+    size_t vertexBytes = SPHERE_VERTEX_COUNT(sphere->stacks, sphere->sectors) * sizeof(PositionVertex);
+    size_t indexBytes = SPHERE_INDEX_COUNT(sphere->stacks, sphere->sectors) * sizeof(MeshIndex);
+    char *scratch = malloc(vertexBytes + indexBytes);
+    if (!scratch)
+    {
+        printf("Memory allocation error for sphere mesh\n");
+        return;
+    }
+    PositionVertex *vertices = (PositionVertex *)scratch;
+    MeshIndex *indices = (MeshIndex *)(scratch + vertexBytes);
+
+    sphere_gen_stacks_sectors(sphere, vertices);
+    sphere_gen_indices(sphere, indices);
+
+    // drawn once per instance, so reorder for the post-transform cache and then for fetch locality
+    int vertexCount = SPHERE_VERTEX_COUNT(sphere->stacks, sphere->sectors);
+#ifdef MESHOPT_VERBOSE
+    float acmrBefore = meshopt_acmr(indices, sphere->index_count, vertexCount, MESHOPT_CACHE_SIZE);
+#endif
+    if (meshopt_optimizeCache(indices, sphere->index_count, vertexCount, MESHOPT_CACHE_SIZE) == 0)
+        meshopt_optimizeFetch(vertices, sizeof(PositionVertex), vertexCount, indices, sphere->index_count);
+#ifdef MESHOPT_VERBOSE
+    printf("Sphere %dx%d ACMR %.3f -> %.3f\n", sphere->stacks, sphere->sectors, acmrBefore,
+           meshopt_acmr(indices, sphere->index_count, vertexCount, MESHOPT_CACHE_SIZE));
+#endif
 
-    glGenVertexArrays(1, &sphere->VAO);
     glGenBuffers(1, &sphere->VBO);
     glGenBuffers(1, &sphere->EBO);
 
-    glBindVertexArray(sphere->VAO);
-
-    if (!sphere->VAO || !sphere->VBO || !sphere->EBO)
+    if (!sphere->VBO || !sphere->EBO)
     {
-        printf("Error generating VAO/VBO/EBO\n");
+        printf("Error generating VBO/EBO\n");
+        free(scratch);
         return;
     }
 
     glBindBuffer(GL_ARRAY_BUFFER, sphere->VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(sphere->vertices), sphere->vertices, GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, vertexBytes, vertices, GL_STATIC_DRAW);
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sphere->EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(sphere->indices), sphere->indices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(0);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sphere->index_count * sizeof(MeshIndex), indices, GL_STATIC_DRAW);
 
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void *)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void *)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    free(scratch);
 };
 
-void sphere_setAngle(Sphere *sphere, float angle)
+void sphere_bind(Sphere *sphere)
 {
-    sphere->angle = angle;
-};
-
-void sphere_draw(Sphere *sphere, Shader *sh, mat4 view, mat4 projection)
-{
-    glUseProgram(sh->ID);
-
-    mat4 model;
-    glm_mat4_identity(model);
-    glm_rotate_y(model, glm_rad(sphere->angle), model);
-    glm_translate(model, sphere->position);
-
-    mat4 result;
-    // order matters
-    glm_mat4_mul(view, model, result);
-    glm_mat4_mul(projection, result, result);
-
-    unsigned int modelLoc = glGetUniformLocation(sh->ID, "model");
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, (const GLfloat *)model);
-
-    unsigned int transformLoc = glGetUniformLocation(sh->ID, "transform");
-    glUniformMatrix4fv(transformLoc, 1, GL_FALSE, (const GLfloat *)result);
+    glBindBuffer(GL_ARRAY_BUFFER, sphere->VBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sphere->EBO);
 
-    glBindVertexArray(sphere->VAO);
-    glDrawElements(GL_TRIANGLES, 6 * SECTOR_COUNT * STACK_COUNT, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    vertex_bindPosition();
 };
 
 void sphere_delete(Sphere *sphere)
 {
-    glDeleteVertexArrays(1, &sphere->VAO);
     glDeleteBuffers(1, &sphere->VBO);
     glDeleteBuffers(1, &sphere->EBO);
-};
\ No newline at end of file
+};
@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <structure.h>
+
+static size_t align_up(size_t offset)
+{
+    return (offset + STRUCTURE_ALIGN - 1) & ~(size_t)(STRUCTURE_ALIGN - 1);
+}
+
+// reserves `bytes` at the end of the block layout, returns the array's offset
+static size_t reserve(size_t *size, size_t bytes)
+{
+    size_t offset = align_up(*size);
+    *size = offset + bytes;
+    return offset;
+}
+
+int structure_init(Structure *s, Arena *arena, int atom_count, int bond_count)
+{
+    memset(s, 0, sizeof(Structure));
+    if (atom_count < 0 || bond_count < 0)
+        return -1;
+
+    size_t atoms = (size_t)atom_count;
+    size_t bonds = (size_t)bond_count;
+
+    // floats first so the wide arrays share the block's alignment
+    size_t size = 0;
+    size_t x = reserve(&size, atoms * sizeof(float));
+    size_t y = reserve(&size, atoms * sizeof(float));
+    size_t z = reserve(&size, atoms * sizeof(float));
+    size_t radius = reserve(&size, atoms * sizeof(float));
+    size_t bond_a = reserve(&size, bonds * sizeof(int));
+    size_t bond_b = reserve(&size, bonds * sizeof(int));
+    size_t element = reserve(&size, atoms);
+    size_t color = reserve(&size, atoms);
+    size_t bond_order = reserve(&size, bonds);
+    size = align_up(size);
+
+    // both return 16 byte aligned memory (malloc on the 64-bit targets we build for)
+    char *block = arena ? arena_alloc(arena, size) : malloc(size > 0 ? size : STRUCTURE_ALIGN);
+    if (!block)
+    {
+        printf("Memory allocation error for structure\n");
+        return -1;
+    }
+    memset(block, 0, size);
+
+    s->atom_count = atom_count;
+    s->bond_count = bond_count;
+    s->x = (float *)(block + x);
+    s->y = (float *)(block + y);
+    s->z = (float *)(block + z);
+    s->radius = (float *)(block + radius);
+    s->bond_a = (int *)(block + bond_a);
+    s->bond_b = (int *)(block + bond_b);
+    s->element = (unsigned char *)(block + element);
+    s->color = (unsigned char *)(block + color);
+    s->bond_order = (unsigned char *)(block + bond_order);
+    s->block = block;
+    s->block_size = size;
+    s->arena = arena;
+    return 0;
+}
+
+int structure_resizeBonds(Structure *s, int bond_count)
+{
+    Structure resized;
+    if (structure_init(&resized, s->arena, s->atom_count, bond_count) != 0)
+        return -1;
+
+    size_t atoms = (size_t)s->atom_count;
+    memcpy(resized.x, s->x, atoms * sizeof(float));
+    memcpy(resized.y, s->y, atoms * sizeof(float));
+    memcpy(resized.z, s->z, atoms * sizeof(float));
+    memcpy(resized.radius, s->radius, atoms * sizeof(float));
+    memcpy(resized.element, s->element, atoms);
+    memcpy(resized.color, s->color, atoms);
+
+    size_t kept = (size_t)(bond_count < s->bond_count ? bond_count : s->bond_count);
+    memcpy(resized.bond_a, s->bond_a, kept * sizeof(int));
+    memcpy(resized.bond_b, s->bond_b, kept * sizeof(int));
+    memcpy(resized.bond_order, s->bond_order, kept);
+
+    memcpy(resized.palette, s->palette, sizeof(s->palette));
+    resized.palette_count = s->palette_count;
+
+    structure_delete(s);
+    *s = resized;
+    return 0;
+}
+
+// palette index of a color, added on first use; a full palette reuses the closest entry
+static unsigned char palette_index(Structure *s, vec3 color)
+{
+    int closest = 0;
+    float closestDist = 1e30f;
+    for (int i = 0; i < s->palette_count; i++)
+    {
+        float dist = glm_vec3_distance2(s->palette[i], color);
+        if (dist == 0.0f)
+            return (unsigned char)i;
+        if (dist < closestDist)
+        {
+            closestDist = dist;
+            closest = i;
+        }
+    }
+
+    if (s->palette_count == STRUCTURE_PALETTE_SIZE)
+        return (unsigned char)closest;
+
+    glm_vec3_copy(color, s->palette[s->palette_count]);
+    return (unsigned char)s->palette_count++;
+}
+
+void structure_setAtom(Structure *s, int i, int element, vec3 position, vec3 color, float radius)
+{
+    s->x[i] = position[0];
+    s->y[i] = position[1];
+    s->z[i] = position[2];
+    s->radius[i] = radius;
+    s->element[i] = (unsigned char)element;
+    s->color[i] = palette_index(s, color);
+}
+
+void structure_setBond(Structure *s, int i, int a, int b, int order)
+{
+    s->bond_a[i] = a;
+    s->bond_b[i] = b;
+    s->bond_order[i] = (unsigned char)order;
+}
+
+void structure_getPosition(const Structure *s, int i, vec3 position)
+{
+    position[0] = s->x[i];
+    position[1] = s->y[i];
+    position[2] = s->z[i];
+}
+
+void structure_getColor(const Structure *s, int i, vec3 color)
+{
+    glm_vec3_copy((float *)s->palette[s->color[i]], color);
+}
+
+void structure_delete(Structure *s)
+{
+    // arena blocks go away with their arena
+    if (!s->arena)
+        free(s->block);
+    memset(s, 0, sizeof(Structure));
+}
@@ -0,0 +1,53 @@
+#include <stddef.h>
+#include <vertex.h>
+
+static GLshort pack_snorm16(float v)
+{
+    v = glm_clamp(v, -1.0f, 1.0f);
+    return (GLshort)roundf(v * 32767.0f);
+}
+
+static GLuint pack_snorm10(float v)
+{
+    v = glm_clamp(v, -1.0f, 1.0f);
+    return (GLuint)((int)roundf(v * 511.0f) & 0x3ff);
+}
+
+void vertex_packPosition(vec3 position, GLshort packed[4])
+{
+    packed[0] = pack_snorm16(position[0]);
+    packed[1] = pack_snorm16(position[1]);
+    packed[2] = pack_snorm16(position[2]);
+    packed[3] = 0;
+}
+
+GLuint vertex_packNormal(vec3 normal)
+{
+    return pack_snorm10(normal[0]) | pack_snorm10(normal[1]) << 10 | pack_snorm10(normal[2]) << 20;
+}
+
+void vertex_packColor(vec3 color, GLubyte packed[4])
+{
+    for (int i = 0; i < 3; i++)
+    {
+        packed[i] = (GLubyte)roundf(glm_clamp(color[i], 0.0f, 1.0f) * 255.0f);
+    }
+    packed[3] = 255;
+}
+
+void vertex_bindPosition(void)
+{
+    glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, sizeof(PositionVertex), (void *)offsetof(PositionVertex, position));
+    glEnableVertexAttribArray(0);
+}
+
+void vertex_bindMesh(void)
+{
+    // position(x, y, z)
+    glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, sizeof(MeshVertex), (void *)offsetof(MeshVertex, position));
+    glEnableVertexAttribArray(0);
+
+    // normals(nx, ny, nz)
+    glVertexAttribPointer(2, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(MeshVertex), (void *)offsetof(MeshVertex, normal));
+    glEnableVertexAttribArray(2);
+}
@@ -0,0 +1,24 @@
+#version 330 core
+
+// Emits the atoms static/atom_cull_vs.glsl kept; transform feedback appends them, in
+// AtomInstance layout, to the per-frame instance buffer.
+layout (points) in;
+layout (points, max_vertices = 1) out;
+
+in vec4 vCenterRadius[];
+flat in uint vColor[];
+flat in int vKeep[];
+
+out vec4 oCenterRadius;
+flat out uint oColor;
+
+void main()
+{
+   if (vKeep[0] == 0)
+      return;
+
+   oCenterRadius = vCenterRadius[0];
+   oColor = vColor[0];
+   EmitVertex();
+   EndPrimitive();
+}
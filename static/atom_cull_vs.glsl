@@ -0,0 +1,35 @@
+#version 330 core
+
+// One point per atom of the static instance buffer; atoms outside the frustum or outside
+// the projected size range are dropped by static/atom_cull_gs.glsl. Same tests as the CPU path.
+layout (location = 1) in uint iColor; // RGBA8, passed through bit for bit
+layout (location = 3) in vec4 iCenterRadius; // (x, y, z, radius)
+
+uniform vec4 planes[6];   // view frustum in molecule space, inside is dot >= 0
+uniform mat4 modelView;
+uniform float pixelScale; // molecule-space radius / view depth -> pixels
+uniform vec2 pixelRange;  // kept when range.x <= projected radius < range.y
+
+out vec4 vCenterRadius;
+flat out uint vColor;
+flat out int vKeep;
+
+void main()
+{
+   vec3 center = iCenterRadius.xyz;
+   float radius = iCenterRadius.w;
+
+   bool inside = true;
+   for (int p = 0; p < 6; p++)
+   {
+      inside = inside && dot(planes[p].xyz, center) + planes[p].w >= -radius;
+   }
+
+   // the eye inside the sphere counts as the largest size
+   float depth = -(modelView * vec4(center, 1.0f)).z;
+   float pixels = depth <= radius ? 3.0e38f : radius * pixelScale / depth;
+
+   vKeep = inside && pixels >= pixelRange.x && pixels < pixelRange.y ? 1 : 0;
+   vCenterRadius = iCenterRadius;
+   vColor = iColor;
+}
@@ -0,0 +1,47 @@
+#version 330 core
+
+layout (std140) uniform Frame
+{
+    mat4 view;
+    mat4 projection;
+    mat4 screen;
+    vec4 lightPos;
+    vec4 lightColor;
+};
+
+in vec3 viewPos;
+flat in vec3 sphereCenter;
+flat in float sphereRadius;
+flat in vec3 lightViewPos;
+in vec4 vertexColor;
+
+out vec4 FragColor;
+
+void main()
+{
+    // ray from the eye (view space origin) through this fragment
+    vec3 dir = normalize(viewPos);
+    float b = dot(dir, sphereCenter);
+    float c = dot(sphereCenter, sphereCenter) - sphereRadius * sphereRadius;
+    float disc = b * b - c;
+    if (disc < 0.0f)
+        discard;
+
+    vec3 hit = dir * (b - sqrt(disc));
+
+    vec4 clip = projection * vec4(hit, 1.0f);
+    gl_FragDepth = 0.5f * (clip.z / clip.w) + 0.5f;
+
+    // inward normal, matching the sphere mesh
+    vec3 norm = (sphereCenter - hit) / sphereRadius;
+
+    float ambientStrength = 0.1f;
+    vec3 ambient = ambientStrength * lightColor.rgb;
+
+    vec3 lightDir = normalize(lightViewPos - hit);
+    float diff = max(dot(norm, lightDir), 0.0f);
+    vec3 diffuse = diff * lightColor.rgb;
+
+    vec3 result = ambient + diffuse;
+    FragColor = vec4(result, 1.0f) * vertexColor;
+}
@@ -0,0 +1,42 @@
+#version 330 core
+
+layout (std140) uniform Frame
+{
+    mat4 view;
+    mat4 projection;
+    mat4 screen;
+    vec4 lightPos;
+    vec4 lightColor;
+};
+
+// Screen-aligned quad per atom, expanded from gl_VertexID (triangle strip of 4).
+layout (location = 1) in vec4 iColor; // RGBA8, normalized
+layout (location = 3) in vec4 iCenterRadius; // (x, y, z, radius)
+
+uniform mat4 model;
+
+out vec3 viewPos;            // quad point in view space, the ray goes through it
+flat out vec3 sphereCenter;  // view space
+flat out float sphereRadius;
+flat out vec3 lightViewPos;
+out vec4 vertexColor;
+
+void main()
+{
+   vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0f - 1.0f;
+
+   vec3 center = vec3(view * model * vec4(iCenterRadius.xyz, 1.0f));
+   float radius = iCenterRadius.w * length(vec3(model[0])); // model has uniform scale
+
+   // grow the quad so the perspective silhouette of the sphere stays inside it
+   float d2 = dot(center, center);
+   float grow = 1.2f * sqrt(d2 / max(d2 - radius * radius, 1e-4f));
+
+   viewPos = center + vec3(corner * radius * grow, 0.0f);
+   gl_Position = projection * vec4(viewPos, 1.0f);
+
+   sphereCenter = center;
+   sphereRadius = radius;
+   lightViewPos = vec3(view * vec4(lightPos.xyz, 1.0f));
+   vertexColor = iColor;
+}
@@ -0,0 +1,32 @@
+#version 330 core
+
+layout (std140) uniform Frame
+{
+    mat4 view;
+    mat4 projection;
+    mat4 screen;
+    vec4 lightPos;
+    vec4 lightColor;
+};
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec4 iColor; // RGBA8, normalized
+layout (location = 3) in vec4 iCenterRadius; // (x, y, z, radius)
+
+uniform mat4 model;
+uniform mat3 normalMatrix; // rotation part of model
+
+out vec3 Normal;
+out vec3 FragPos;
+out vec4 vertexColor;
+
+void main()
+{
+   vec4 worldPos = model * vec4(iCenterRadius.xyz + aPos * iCenterRadius.w, 1.0f);
+   gl_Position = projection * view * worldPos;
+   // unit sphere: the (inward facing) normal is the negated position; instances only
+   // translate and scale uniformly, so the molecule rotation is enough
+   Normal = normalMatrix * -aPos;
+   FragPos = vec3(worldPos);
+   vertexColor = iColor;
+}
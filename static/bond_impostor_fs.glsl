@@ -0,0 +1,75 @@
+#version 330 core
+
+layout (std140) uniform Frame
+{
+    mat4 view;
+    mat4 projection;
+    mat4 screen;
+    vec4 lightPos;
+    vec4 lightColor;
+};
+
+in vec3 viewPos;
+flat in vec3 cylinderA;
+flat in vec3 cylinderB;
+flat in float cylinderRadius;
+flat in vec3 lightViewPos;
+in vec4 vertexColor;
+
+out vec4 FragColor;
+
+void main()
+{
+    // ray from the eye (view space origin) through this fragment against a capped cylinder
+    vec3 rd = normalize(viewPos);
+    vec3 ba = cylinderB - cylinderA;
+    vec3 oc = -cylinderA;
+
+    float baba = dot(ba, ba);
+    float bard = dot(ba, rd);
+    float baoc = dot(ba, oc);
+
+    float k2 = baba - bard * bard;
+    float k1 = baba * dot(oc, rd) - baoc * bard;
+    float k0 = baba * dot(oc, oc) - baoc * baoc - cylinderRadius * cylinderRadius * baba;
+
+    float h = k1 * k1 - k2 * k0;
+    if (h < 0.0f)
+        discard;
+    h = sqrt(h);
+
+    // lateral surface
+    float t = (-k1 - h) / k2;
+    float y = baoc + t * bard;
+    vec3 norm;
+    if (y > 0.0f && y < baba)
+    {
+        norm = (oc + t * rd - ba * y / baba) / cylinderRadius;
+    }
+    else
+    {
+        // caps
+        t = ((y < 0.0f ? 0.0f : baba) - baoc) / bard;
+        if (abs(k1 + k2 * t) >= h)
+            discard;
+        norm = ba * sign(y) / sqrt(baba);
+    }
+
+    vec3 hit = t * rd;
+
+    vec4 clip = projection * vec4(hit, 1.0f);
+    gl_FragDepth = 0.5f * (clip.z / clip.w) + 0.5f;
+
+    // inward normal, matching the cylinder mesh
+    norm = -norm;
+
+    float ambientStrength = 0.1f;
+    vec3 ambient = ambientStrength * lightColor.rgb;
+
+    vec3 lightDir = normalize(lightViewPos - hit);
+    float diff = max(dot(norm, lightDir), 0.0f);
+    vec3 diffuse = diff * lightColor.rgb;
+
+    vec3 result = ambient + diffuse;
+    FragColor = vec4(result, 1.0f) * vertexColor;
+}
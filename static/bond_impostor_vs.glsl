@@ -0,0 +1,44 @@
+#version 330 core
+
+layout (std140) uniform Frame
+{
+    mat4 view;
+    mat4 projection;
+    mat4 screen;
+    vec4 lightPos;
+    vec4 lightColor;
+};
+
+// Bounding box per bond line, expanded from gl_VertexID (triangle strip of 14).
+layout (location = 1) in vec4 iColor; // RGBA8, normalized
+layout (location = 3) in mat4 iTransform; // locations 3-6, unit cylinder -> molecule space
+
+uniform mat4 model;
+
+out vec3 viewPos;           // box point in view space, the ray goes through it
+flat out vec3 cylinderA;    // view space end points
+flat out vec3 cylinderB;
+flat out float cylinderRadius;
+flat out vec3 lightViewPos;
+out vec4 vertexColor;
+
+void main()
+{
+   int b = 1 << gl_VertexID;
+   vec3 corner = vec3((0x287a & b) != 0, (0x02af & b) != 0, (0x31e3 & b) != 0);
+   corner = corner * 2.0f - 1.0f;
+   corner.z *= 0.5f; // unit cylinder spans z in [-0.5, 0.5]
+
+   mat4 modelView = view * model * iTransform;
+   vec3 center = vec3(modelView[3]);
+   vec3 axis = vec3(modelView[2]);
+
+   viewPos = vec3(modelView * vec4(corner, 1.0f));
+   gl_Position = projection * vec4(viewPos, 1.0f);
+
+   cylinderA = center - 0.5f * axis;
+   cylinderB = center + 0.5f * axis;
+   cylinderRadius = length(vec3(modelView[0]));
+   lightViewPos = vec3(view * vec4(lightPos.xyz, 1.0f));
+   vertexColor = iColor;
+}
@@ -1,24 +1,30 @@
 #version 330 core
 
+layout (std140) uniform Frame
+{
+    mat4 view;
+    mat4 projection;
+    mat4 screen;
+    vec4 lightPos;
+    vec4 lightColor;
+};
+
 in vec3 Normal;
 in vec3 FragPos;
 in vec4 vertexColor;
 
-uniform vec3 lightPos;  
-uniform vec3 lightColor;
-
 out vec4 FragColor;
 
 void main()
 {
     float ambientStrength = 0.1f;
-    vec3 ambient = ambientStrength * lightColor;
+    vec3 ambient = ambientStrength * lightColor.rgb;
 
     vec3 norm = normalize(Normal);
-    vec3 lightDir = normalize(lightPos - FragPos);
+    vec3 lightDir = normalize(lightPos.xyz - FragPos);
 
     float diff = max(dot(norm, lightDir), 0.0f);
-    vec3 diffuse = diff * lightColor;
+    vec3 diffuse = diff * lightColor.rgb;
 
     vec3 result = ambient + diffuse;
     FragColor = vec4(result, 1.0f) * vertexColor;
@@ -0,0 +1,16 @@
+#version 330 core
+
+// One level of the depth pyramid: the farthest of the 2x2 texels below, an odd last
+// row / column folds into its neighbor.
+uniform sampler2D depth; // previous level, texture unit 0
+
+out float farthest;
+
+void main()
+{
+   ivec2 last = textureSize(depth, 0) - 1;
+   ivec2 p = ivec2(gl_FragCoord.xy) * 2;
+   ivec2 q = min(p + 1, last);
+   farthest = max(max(texelFetch(depth, p, 0).r, texelFetch(depth, ivec2(q.x, p.y), 0).r),
+                  max(texelFetch(depth, ivec2(p.x, q.y), 0).r, texelFetch(depth, q, 0).r));
+}
@@ -1,16 +1,24 @@
 #version 330 core
 
+layout (std140) uniform Frame
+{
+    mat4 view;
+    mat4 projection;
+    mat4 screen;
+    vec4 lightPos;
+    vec4 lightColor;
+};
+
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aColor;
 layout (location = 2) in vec3 aNorm;
 
 uniform mat4 model;
-uniform mat4 transform;
 
 out vec4 vertexColor;
 
 void main()
 {
-   gl_Position = transform * vec4(aPos, 1.0);
+   gl_Position = projection * view * model * vec4(aPos, 1.0);
    vertexColor = vec4(aColor, 1.0);
 }
\ No newline at end of file
@@ -1,13 +1,20 @@
 #version 330 core
 
+layout (std140) uniform Frame
+{
+    mat4 view;
+    mat4 projection;
+    mat4 screen;
+    vec4 lightPos;
+    vec4 lightColor;
+};
+
 layout (location = 0) in vec4 vertex; // (x, y, z, w)
 
 out vec2 TexCoords;
 
-uniform mat4 projection;
-
 void main()
 {
-    gl_Position = projection * vec4(vertex.xy, 0.0, 1.0);
+    gl_Position = screen * vec4(vertex.xy, 0.0, 1.0);
     TexCoords = vertex.zw;
 }
@@ -1,11 +1,21 @@
 #version 330 core
 
+layout (std140) uniform Frame
+{
+    mat4 view;
+    mat4 projection;
+    mat4 screen;
+    vec4 lightPos;
+    vec4 lightColor;
+};
+
 layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aColor;
+layout (location = 1) in vec4 iColor; // RGBA8, normalized
 layout (location = 2) in vec3 aNorm;
+layout (location = 3) in mat4 iTransform; // locations 3-6
 
 uniform mat4 model;
-uniform mat4 transform;
+uniform mat3 normalMatrix; // rotation part of model
 
 out vec3 Normal;
 out vec3 FragPos;
@@ -13,8 +23,12 @@ out vec4 vertexColor;
 
 void main()
 {
-   gl_Position = transform * vec4(aPos, 1.0f);
-   Normal = mat3(transpose(inverse(model))) * aNorm;
-   FragPos = vec3(model * vec4(aPos, 1.0f));
-   vertexColor = vec4(aColor, 1.0f);
-}
\ No newline at end of file
+   mat4 instanceModel = model * iTransform;
+   vec4 worldPos = instanceModel * vec4(aPos, 1.0f);
+   gl_Position = projection * view * worldPos;
+   // iTransform scales (radius, radius, height) but cylinder normals have no z, so
+   // its upper 3x3 keeps them perpendicular without an inverse transpose
+   Normal = normalMatrix * (mat3(iTransform) * aNorm);
+   FragPos = vec3(worldPos);
+   vertexColor = iColor;
+}